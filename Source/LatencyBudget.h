@@ -0,0 +1,63 @@
+// LatencyBudget.h
+
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ * Sums the latency of every stage that delays the wet signal, in base-rate
+ * samples. Stages are set whenever the configuration changes (prepare, HQ
+ * toggles), and commit() reports whether the total the host sees changed, so
+ * it's only told when it has to re-align.
+ */
+struct LatencyBudget
+{
+    enum Stage
+    {
+        oversampling, // anti-imaging filters, also delays the dry mix
+        pipeline,     // offline two-block pipeline, delays dry & wet alike
+        numStages
+    };
+
+    static constexpr const char *stageNames[numStages]{"Oversampling",
+                                                       "Pipeline"};
+
+    void set(Stage stage, double samples) { stages[stage] = samples; }
+    double get(Stage stage) const { return stages[stage]; }
+
+    double getTotal() const
+    {
+        double total = 0.0;
+        for (auto s : stages)
+            total += s;
+        return total;
+    }
+
+    /* whole samples, as reported to the host */
+    int getTotalSamples() const { return (int)getTotal(); }
+
+    /**
+     * Call after setting the stages.
+     * @return whether the reported total changed since the last commit
+     */
+    bool commit()
+    {
+        const auto total = getTotalSamples();
+        const bool changed = total != reported;
+        reported = total;
+        return changed;
+    }
+
+    /* e.g. "Oversampling: 6.05, Pipeline: 2048 (total 2054)" */
+    String toString() const
+    {
+        String s;
+        for (int i = 0; i < numStages; ++i)
+            s << stageNames[i] << ": " << stages[i]
+              << (i < numStages - 1 ? ", " : "");
+        return s << " (total " << getTotalSamples() << ")";
+    }
+
+  private:
+    std::array<double, numStages> stages{};
+    int reported = -1;
+};
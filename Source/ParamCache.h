@@ -0,0 +1,100 @@
+// ParamCache.h
+
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ * Audio-thread cache of the parameters read by processDoubleBuffer.
+ * Listener callbacks only set a bit in a dirty mask, and refresh() re-reads
+ * just the parameters that changed since the last (sub-)block, so hosts that
+ * split blocks at parameter events don't pay for every parameter per chunk.
+ */
+struct ParamCache : AudioProcessorValueTreeState::Listener
+{
+    enum ID
+    {
+        inputGain,
+        outputGain,
+        gainLink,
+        bypass,
+        ms,
+        stereoEmphasis,
+        comp,
+        compLink,
+        compPos,
+        ampOn,
+        cabType,
+        doubler,
+        reverbAmt,
+        lfEnhance,
+        lfEnhanceInvert,
+        hfEnhance,
+        hfEnhanceInvert,
+        width,
+        mix,
+        numParams
+    };
+
+    static_assert(numParams <= 32, "dirty mask only holds 32 parameters");
+
+    static constexpr const char *paramIDs[numParams]{
+        "inputGain", "outputGain",      "gainLink",  "bypass",
+        "m/s",       "stereoEmphasis",  "comp",      "compLink",
+        "compPos",   "ampOn",           "cabType",   "doubler",
+        "reverbAmt", "lfEnhance",       "lfEnhanceInvert",
+        "hfEnhance", "hfEnhanceInvert", "width",     "mix"};
+
+    static constexpr uint32 bit(ID id) { return 1u << id; }
+
+    ParamCache(AudioProcessorValueTreeState &a) : apvts(a)
+    {
+        for (int i = 0; i < numParams; ++i) {
+            raw[i] = apvts.getRawParameterValue(paramIDs[i]);
+            jassert(raw[i] != nullptr);
+            values[i] = raw[i]->load();
+            apvts.addParameterListener(paramIDs[i], this);
+        }
+        markAllDirty();
+    }
+
+    ~ParamCache()
+    {
+        for (auto *id : paramIDs)
+            apvts.removeParameterListener(id, this);
+    }
+
+    void parameterChanged(const String &parameterID, float) override
+    {
+        for (int i = 0; i < numParams; ++i) {
+            if (parameterID == paramIDs[i]) {
+                dirty.fetch_or(bit((ID)i));
+                return;
+            }
+        }
+    }
+
+    void markAllDirty() { dirty.store(~0u >> (32 - numParams)); }
+
+    /**
+     * Re-read only the parameters flagged since the last call.
+     * @return mask of the parameters that were refreshed
+     */
+    uint32 refresh()
+    {
+        const auto mask = dirty.exchange(0);
+        for (int i = 0; i < numParams; ++i)
+            if (mask & bit((ID)i))
+                values[i] = raw[i]->load();
+        return mask;
+    }
+
+    float operator[](ID id) const { return values[id]; }
+    bool getBool(ID id) const { return values[id] >= 0.5f; }
+
+  private:
+    AudioProcessorValueTreeState &apvts;
+
+    std::array<std::atomic<float> *, numParams> raw{};
+    std::array<float, numParams> values{};
+    std::atomic<uint32> dirty{0};
+};
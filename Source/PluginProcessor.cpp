@@ -21,17 +21,13 @@ GammaAudioProcessor::GammaAudioProcessor()
               .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
               ),
-      apvts(*this, nullptr, "Parameters", createParams()),
+      apvts(*this, nullptr, "Parameters", createParams()), paramCache(apvts),
       guitar(apvts, meterSource), bass(apvts, meterSource),
       channel(apvts, meterSource),
       cab(apvts,
           (Processors::CabType)apvts.getRawParameterValue("cabType")->load()),
       hfEnhancer(apvts), lfEnhancer(apvts), reverb(apvts),
-      emphLow(apvts, (strix::FloatParameter *)apvts.getParameter("lfEmphasis"),
-              (strix::FloatParameter *)apvts.getParameter("lfEmphasisFreq")),
-      emphHigh(apvts, (strix::FloatParameter *)apvts.getParameter("hfEmphasis"),
-               (strix::FloatParameter *)apvts.getParameter("hfEmphasisFreq")),
-      cutFilters(apvts)
+      emphFilters(apvts), cutFilters(apvts)
 #endif
 {
     inGain = apvts.getRawParameterValue("inputGain");
@@ -50,6 +46,20 @@ GammaAudioProcessor::GammaAudioProcessor()
     apvts.addParameterListener("mode", this);
     apvts.addParameterListener("dist", this);
     apvts.addParameterListener("hq", this);
+    apvts.addParameterListener("hqLowLatency", this);
+    apvts.addParameterListener("fastDiodes", this);
+
+    hfEnhancer.setWorker(&channelWorker);
+    lfEnhancer.setWorker(&channelWorker);
+    emphFilters.setWorker(&channelWorker);
+    cutFilters.setWorker(&channelWorker);
+    reverb.setWorker(&channelWorker);
+
+    for (auto *amp : std::initializer_list<Processors::Processor *>{
+             &guitar, &bass, &channel})
+        amp->setArena(&scratch[frontScratch]);
+    cab.setArena(&scratch[frontScratch]);
+    reverb.setArena(&scratch[backScratch]);
 
     LookAndFeel::getDefaultLookAndFeel().setDefaultSansSerifTypeface(
         getCustomFont());
@@ -69,6 +79,8 @@ GammaAudioProcessor::~GammaAudioProcessor()
     apvts.removeParameterListener("mode", this);
     apvts.removeParameterListener("dist", this);
     apvts.removeParameterListener("hq", this);
+    apvts.removeParameterListener("hqLowLatency", this);
+    apvts.removeParameterListener("fastDiodes", this);
 }
 
 //==============================================================================
@@ -132,9 +144,10 @@ void GammaAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     for (auto &o : oversample)
         o.initProcessing(samplesPerBlock);
+    minPhaseOS.initProcessing(samplesPerBlock);
 
     setOversampleIndex();
-    int ovs_fac = oversample[os_index].getOversamplingFactor();
+    int ovs_fac = (int)getOversamplingFactor();
 
     maxBlockSize = samplesPerBlock;
     SR = sampleRate;
@@ -148,13 +161,18 @@ void GammaAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 
     currentMode = (Mode)apvts.getRawParameterValue("mode")->load();
 
-    emphLow.prepare(spec);
-    emphHigh.prepare(spec);
+    emphFilters.prepare(spec);
 
     guitar.prepare(osSpec);
     bass.prepare(osSpec);
     channel.prepare(osSpec);
 
+    /* the compressor isn't part of the nonlinear chain, so it runs at the
+     * base rate and an HQ toggle doesn't touch it */
+    guitar.comp.prepare(spec);
+    bass.comp.prepare(spec);
+    channel.comp.prepare(spec);
+
     guitar.setToneControl(0,
                           calcBassParam(*apvts.getRawParameterValue("bass")));
     guitar.setToneControl(1, *apvts.getRawParameterValue("mid"));
@@ -183,15 +201,64 @@ void GammaAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     sm_mix.reset(spec.sampleRate, 0.01f);
     dryDelay.prepare(spec);
     dryDelay.setMaximumDelayInSamples(spec.maximumBlockSize + 256);
+    bypassFade.setFadeTime(sampleRate, 0.01f);
+    bypassFade.jumpTo(apvts.getRawParameterValue("bypass")->load() >= 0.5f);
+    paramCache.markAllDirty();
 
     doubler.prepare(spec);
     doubler.setDelayTime(18);
 
-    doubleBuffer.setSize(2, samplesPerBlock);
-    preAmpBuf.setSize(spec.numChannels, samplesPerBlock);
-    preAmpCrossfade.setFadeTime(spec.sampleRate, 0.1f);
-
-    simd.setInterleavedBlockSize(spec.numChannels, samplesPerBlock);
+    /* every scratch buffer the chain uses in one allocation. The amps are
+     * sized for HQ, so toggling it doesn't need a new arena, & everything is
+     * sized for stereo, the most the chain runs whatever the bus layout */
+    using Processors::ScratchArena;
+    auto maxSpec = spec;
+    maxSpec.numChannels = 2;
+    auto maxOsSpec = maxSpec;
+    maxOsSpec.maximumBlockSize =
+        spec.maximumBlockSize *
+        (uint32)oversample.back().getOversamplingFactor();
+    const auto blockBytes = ScratchArena::bytesForBlock<double>(
+        maxSpec.numChannels, spec.maximumBlockSize);
+#if USE_SIMD
+    const auto numVec =
+        Processors::Interleaver::numVecChannels(maxSpec.numChannels);
+    const auto vecBlockBytes =
+        ScratchArena::bytesForBlock<vec>(numVec, spec.maximumBlockSize);
+    const auto ampBlockBytes =
+        ScratchArena::bytesForBlock<vec>(numVec, maxOsSpec.maximumBlockSize);
+    const auto cabBytes = 2 * vecBlockBytes; // interleaved block & its copy
+#else
+    const size_t ampBlockBytes = 0;
+    const auto cabBytes = blockBytes;
+#endif
+    /* nothing allocates more at once than one channel of the HQ amp block */
+    const auto maxAllocBytes = maxOsSpec.maximumBlockSize * sizeof(vec);
+    scratch.prepare(
+        {
+            ScratchArena::bytesForBlock<double>(2, spec.maximumBlockSize),
+            jmax(blockBytes, ampBlockBytes) /* amp-off path */ +
+                ampBlockBytes +
+                Processors::Processor::scratchBytes(maxOsSpec) + cabBytes,
+            Processors::ReverbManager::scratchBytes(maxSpec) +
+                blockBytes /* bypass fade */,
+        },
+        maxAllocBytes);
+    ampFade.setFadeTime(spec.sampleRate, 0.1f);
+    ampFade.jumpTo(apvts.getRawParameterValue("ampOn")->load() >= 0.5f);
+
+
+    preparePipeline(samplesPerBlock, (int)spec.numChannels);
+    /* only offline: live, a second realtime thread per instance competes
+     * with every other plugin for the host's cores. The pipeline already
+     * keeps a second core busy, and its two halves would contend for the
+     * channel worker */
+    if (isNonRealtime() && !pipelined &&
+        (size_t)samplesPerBlock >= Processors::ChannelRunner::minBlockSize)
+        channelWorker.start();
+    else
+        channelWorker.stop();
+    updateLatency();
 }
 
 void GammaAudioProcessor::releaseResources()
@@ -202,14 +269,15 @@ void GammaAudioProcessor::releaseResources()
     hfEnhancer.reset();
     lfEnhancer.reset();
     cutFilters.reset();
-    emphLow.reset();
-    emphHigh.reset();
+    emphFilters.reset();
     cab.reset();
     reverb.reset();
     emphasisIn.reset();
     emphasisOut.reset();
     doubler.reset();
     mixDelay.reset();
+    pipeWorker.stop();
+    channelWorker.stop();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -225,6 +293,17 @@ bool GammaAudioProcessor::isBusesLayoutSupported(
 void GammaAudioProcessor::parameterChanged(const String &parameterID,
                                            float newValue)
 {
+    if (restoringState) {
+        /* a restored outputGain already has the link applied, & oversampling
+         * is re-prepared once the whole state is in */
+        if (parameterID == "gainLink")
+            return;
+        if (parameterID == "hq" || parameterID == "hqLowLatency") {
+            oversamplingChanged = true;
+            return;
+        }
+    }
+
     if (parameterID == "mode") {
         currentMode = (Mode)newValue;
         lfEnhancer.setMode((Processors::ProcessorType)currentMode);
@@ -273,28 +352,87 @@ void GammaAudioProcessor::parameterChanged(const String &parameterID,
             // - apvts.getRawParameterValue("inputGain")->load());
         }
     } else if (parameterID == "hq") {
-        setOversampleIndex();
-        auto ovs_fac = oversample[os_index].getOversamplingFactor();
-        lastSampleRate = SR * ovs_fac;
-        dsp::ProcessSpec osSpec{lastSampleRate, uint32(maxBlockSize * ovs_fac),
-                                (uint32)getTotalNumInputChannels()};
-        suspendProcessing(true);
-        guitar.prepare(osSpec);
-        bass.prepare(osSpec);
-        channel.update(osSpec, *apvts.getRawParameterValue("bass"),
-                       *apvts.getRawParameterValue("mid"),
-                       *apvts.getRawParameterValue("treble"));
-        suspendProcessing(false);
+        updateOversampling();
+    } else if (parameterID == "hqLowLatency") {
+        /* only picks the HQ filters, nothing to re-prepare while HQ (or
+         * Render HQ, offline) is off */
+        if (os_index != osOff)
+            updateOversampling();
+    } else if (parameterID == "fastDiodes") {
+        updateDiodeQuality();
     }
 }
 
+void GammaAudioProcessor::updateOversampling()
+{
+    setOversampleIndex();
+    auto ovs_fac = getOversamplingFactor();
+    lastSampleRate = SR * ovs_fac;
+    dsp::ProcessSpec osSpec{lastSampleRate, uint32(maxBlockSize * ovs_fac),
+                            (uint32)getTotalNumInputChannels()};
+    suspendProcessing(true);
+    minPhaseOS.reset();
+    guitar.prepare(osSpec);
+    bass.prepare(osSpec);
+    channel.update(osSpec, *apvts.getRawParameterValue("bass"),
+                   *apvts.getRawParameterValue("mid"),
+                   *apvts.getRawParameterValue("treble"));
+    updateLatency();
+    suspendProcessing(false);
+}
+
 void GammaAudioProcessor::setOversampleIndex()
 {
     if (*apvts.getRawParameterValue("hq") ||
         (isNonRealtime() && *apvts.getRawParameterValue("renderHQ")))
-        os_index = 1;
+        os_index = *apvts.getRawParameterValue("hqLowLatency") ? osMinPhase
+                                                                : osLinearPhase;
     else
-        os_index = 0;
+        os_index = osOff;
+}
+
+void GammaAudioProcessor::updateDiodeQuality()
+{
+    const auto quality = *apvts.getRawParameterValue("fastDiodes")
+                             ? WDFT::DiodeQuality::Good
+                             : WDFT::DiodeQuality::Best;
+    suspendProcessing(true);
+    for (auto *amp : std::initializer_list<Processors::Processor *>{
+             &guitar, &bass, &channel})
+        amp->setDiodeQuality(quality);
+    suspendProcessing(false);
+}
+
+/* float -> double, optionally into a second channel as well so a mono input
+ * is only read once when it's duplicated to stereo. out & dup come from the
+ * scratch arena, so they're aligned */
+static void convertToDouble(const float *in, double *out, double *dup,
+                            int numSamples)
+{
+    constexpr int width = (int)vec::size;
+    int i = 0;
+    for (; i + width <= numSamples; i += width) {
+        const auto x = xsimd::load_as<double>(in + i, xsimd::unaligned_mode());
+        x.store_aligned(out + i);
+        if (dup != nullptr)
+            x.store_aligned(dup + i);
+    }
+    for (; i < numSamples; ++i) {
+        out[i] = static_cast<double>(in[i]);
+        if (dup != nullptr)
+            dup[i] = out[i];
+    }
+}
+
+static void convertToFloat(const double *in, float *out, int numSamples)
+{
+    constexpr int width = (int)vec::size;
+    int i = 0;
+    for (; i + width <= numSamples; i += width)
+        xsimd::store_as(out + i, xsimd::load_aligned(in + i),
+                        xsimd::unaligned_mode());
+    for (; i < numSamples; ++i)
+        out[i] = static_cast<float>(in[i]);
 }
 
 void GammaAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
@@ -307,24 +445,32 @@ void GammaAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    doubleBuffer.makeCopyOf(buffer, true);
-
-    if (totalNumInputChannels < totalNumOutputChannels)
-        doubleBuffer.copyFrom(1, 0, doubleBuffer.getReadPointer(0),
-                              doubleBuffer.getNumSamples());
-
-    processDoubleBuffer(doubleBuffer, totalNumOutputChannels < 2);
-
-    auto L = doubleBuffer.getReadPointer(0);
-    auto outL = buffer.getWritePointer(0);
-    for (auto i = 0; i < buffer.getNumSamples(); ++i)
-        outL[i] = static_cast<float>(L[i]);
-
-    if (totalNumOutputChannels > 1) {
-        auto R = doubleBuffer.getReadPointer(1);
-        auto outR = buffer.getWritePointer(1);
-        for (auto i = 0; i < buffer.getNumSamples(); ++i)
-            outR[i] = static_cast<float>(R[i]);
+    /* convert in chunks, the I/O arena is sized for maxBlockSize */
+    auto &arena = scratch[ioScratch];
+    const int numChannels = jmin(buffer.getNumChannels(), 2);
+    for (int pos = 0; pos < buffer.getNumSamples(); pos += maxBlockSize) {
+        const int numSamples = jmin(maxBlockSize, buffer.getNumSamples() - pos);
+        Processors::ScratchArena::Scope scope(arena);
+        auto doubleBuffer = arena.allocateBuffer<double>(2, numSamples);
+        if (arena.takeOverflow())
+            continue; // leave this chunk unprocessed
+
+        const bool duplicate =
+            totalNumInputChannels < totalNumOutputChannels || numChannels < 2;
+        convertToDouble(buffer.getReadPointer(0, pos),
+                        doubleBuffer.getWritePointer(0),
+                        duplicate ? doubleBuffer.getWritePointer(1) : nullptr,
+                        numSamples);
+        if (!duplicate)
+            convertToDouble(buffer.getReadPointer(1, pos),
+                            doubleBuffer.getWritePointer(1), nullptr,
+                            numSamples);
+
+        processDoubleBuffer(doubleBuffer, totalNumOutputChannels < 2);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            convertToFloat(doubleBuffer.getReadPointer(ch),
+                           buffer.getWritePointer(ch, pos), numSamples);
     }
 }
 
@@ -358,19 +504,26 @@ juce::AudioProcessorEditor *GammaAudioProcessor::createEditor()
 //==============================================================================
 void GammaAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
 {
-    auto state = apvts.copyState();
-    auto xml = state.createXml();
-    xml->setAttribute("Preset", currentPreset);
-    copyXmlToBinary(*xml, destData);
+    StateCodec::write(apvts, currentPreset, destData);
 }
 
 void GammaAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
 {
-    auto xml = getXmlFromBinary(data, sizeInBytes);
-    if (xml != nullptr) {
+    restoringState = true;
+    oversamplingChanged = false;
+
+    String preset;
+    if (StateCodec::read(apvts, data, sizeInBytes, preset)) {
+        currentPreset = preset;
+    } else if (auto xml = getXmlFromBinary(data, sizeInBytes)) {
+        // sessions saved before the binary format
         apvts.replaceState(ValueTree::fromXml(*xml));
         currentPreset = xml->getStringAttribute("Preset");
     }
+
+    restoringState = false;
+    if (oversamplingChanged)
+        updateOversampling();
 }
 
 //==============================================================================
@@ -503,5 +656,12 @@ GammaAudioProcessor::createParams()
     params.emplace_back(
         std::make_unique<bParam>(ParameterID("bypass", 1), "Bypass", false));
 
+    /* added since the first release: only ever append, hosts & VST2 sessions
+     * address parameters by index */
+    params.emplace_back(std::make_unique<bParam>(
+        ParameterID("hqLowLatency", 2), "HQ Min Phase", false));
+    params.emplace_back(std::make_unique<bParam>(
+        ParameterID("fastDiodes", 2), "Fast Pedal Diodes", false));
+
     return {params.begin(), params.end()};
 }
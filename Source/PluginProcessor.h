@@ -17,8 +17,11 @@
 
 #include <Arbor_modules.h>
 #include <chowdsp_wdf/chowdsp_wdf.h>
+#include "LatencyBudget.h"
+#include "ParamCache.h"
 #include "Presets/PresetManager.h"
 #include "Processors/Processors.h"
+#include "StateCodec.h"
 #include "UI/UI.h"
 #if !PRODUCTION_BUILD
 #define DEV_BUILD 1
@@ -104,6 +107,9 @@ class GammaAudioProcessor : public juce::AudioProcessor,
         suspendProcessing(shouldBeLocked);
     }
 
+    /* per-stage breakdown of the latency reported to the host */
+    const LatencyBudget &getLatencyBudget() const { return latency; }
+
     String getWrapperTypeString()
     {
         if (wrapperType == wrapperType_Undefined && is_clap)
@@ -125,10 +131,13 @@ class GammaAudioProcessor : public juce::AudioProcessor,
     std::atomic<float> *inGain, *outGain, *autoGain, *hiGain, *hfEnhance,
         *lfEnhance;
 
+    ParamCache paramCache;
+    LatencyBudget latency;
+    float inGain_raw = 1.f, outGain_raw = 1.f;
+
     float lastInGain = 1.f, lastOutGain = 1.f, lastWidth = 1.f, lastEmph = 0.f;
-    bool lastAmpOn = true;
-    AudioBuffer<double> preAmpBuf, postAmpBuf;
-    strix::Crossfade preAmpCrossfade;
+    // path 0 = amp off, path 1 = amp on
+    Processors::Crossfader ampFade;
 
     /*std::array<ToneStackNodal, 3> toneStack
     { {
@@ -146,9 +155,45 @@ class GammaAudioProcessor : public juce::AudioProcessor,
             2, 2,
             dsp::Oversampling<
                 double>::FilterType::filterHalfBandFIREquiripple)};
-    size_t os_index = 0;
+    /* HQ for tracking: no latency to compensate beyond its group delay */
+    Processors::MinPhaseOversampler minPhaseOS{2};
+
+    enum OversampleIndex
+    {
+        osOff,         // oversample[0], a passthrough
+        osLinearPhase, // oversample[1]
+        osMinPhase,    // minPhaseOS
+    };
+    size_t os_index = osOff;
+
+    size_t getOversamplingFactor()
+    {
+        return os_index == osMinPhase
+                   ? minPhaseOS.getOversamplingFactor()
+                   : oversample[os_index].getOversamplingFactor();
+    }
 
-    AudioBuffer<double> doubleBuffer;
+    double getOversamplingLatency()
+    {
+        return os_index == osMinPhase
+                   ? minPhaseOS.getLatencyInSamples()
+                   : oversample[os_index].getLatencyInSamples();
+    }
+
+    /* one region per thread that processes audio: host I/O conversion, and
+     * the two halves of the chain (which the offline pipeline runs
+     * concurrently) */
+    enum ScratchRegion
+    {
+        ioScratch,
+        frontScratch,
+        backScratch,
+        numScratchRegions
+    };
+    Processors::ScratchMemory<numScratchRegions> scratch;
+#if USE_SIMD
+    Processors::Interleaver simd;
+#endif
 
 #if USE_SIMD
     Processors::Guitar<vec> guitar;
@@ -161,16 +206,13 @@ class GammaAudioProcessor : public juce::AudioProcessor,
     Processors::Channel<double> channel;
     Processors::FDNCab<double> cab;
 #endif
-    Processors::Enhancer<double, Processors::EnhancerType::HF> hfEnhancer;
-    Processors::Enhancer<double, Processors::EnhancerType::LF> lfEnhancer;
+    Processors::Enhancer<Processors::EnhancerType::HF> hfEnhancer;
+    Processors::Enhancer<Processors::EnhancerType::LF> lfEnhancer;
 
     Processors::ReverbManager reverb;
 
     strix::Balance emphasisIn, emphasisOut;
-    Processors::EmphasisFilter<double, Processors::EmphasisFilterType::Low>
-        emphLow;
-    Processors::EmphasisFilter<double, Processors::EmphasisFilterType::High>
-        emphHigh;
+    Processors::EmphasisFilters emphFilters;
 
     strix::MonoToStereo<double> doubler;
 
@@ -179,9 +221,8 @@ class GammaAudioProcessor : public juce::AudioProcessor,
     dsp::DelayLine<double, dsp::DelayLineInterpolationTypes::Thiran> mixDelay;
     SmoothedValue<float> sm_mix;
     dsp::DelayLine<double, dsp::DelayLineInterpolationTypes::Thiran> dryDelay;
-    bool lastBypass = false;
-
-    strix::SIMD<double, dsp::AudioBlock<double>, strix::AudioBlock<vec>> simd;
+    // path 0 = processed, path 1 = dry
+    Processors::Crossfader bypassFade;
 
     enum Mode
     {
@@ -193,30 +234,127 @@ class GammaAudioProcessor : public juce::AudioProcessor,
     Mode currentMode = Mode::Channel;
 
     void setOversampleIndex();
+    /* the pedal's diode model, Best unless "fastDiodes" is on */
+    void updateDiodeQuality();
+    /* re-prepares everything that runs at the oversampled rate */
+    void updateOversampling();
+
+    /* set while setStateInformation() applies a whole state, so listeners
+     * that re-prepare can be deferred & run once at the end */
+    bool restoringState = false, oversamplingChanged = false;
+
+    /* per-block values that both halves of the chain must agree on */
+    struct BlockState
+    {
+        bool mono = false, ms = false, bypassed = false;
+        float stereoEmph = 1.f;
+    };
 
     void processDoubleBuffer(AudioBuffer<double> &buffer, bool mono)
     {
         if (buffer.getNumSamples() < 1) // WHY would you ever send 0 samples?
             return;
-        auto inGain_raw = std::pow(10.f, inGain->load() * 0.05f);
-        auto outGain_raw = std::pow(10.f, outGain->load() * 0.05f);
-        const size_t os_index_ = os_index;
-        const bool isBypassed = (bool)*apvts.getRawParameterValue("bypass");
 
-        if ((bool)*apvts.getRawParameterValue("gainLink"))
-            outGain_raw *= 1.f / inGain_raw;
+        if (pipelined) {
+            processPipelined(buffer, mono);
+            return;
+        }
+
+        /* the scratch arenas are sized for maxBlockSize */
+        const int numChannels = jmin(buffer.getNumChannels(), 2);
+        for (int pos = 0; pos < buffer.getNumSamples(); pos += maxBlockSize) {
+            const int numSamples =
+                jmin(maxBlockSize, buffer.getNumSamples() - pos);
+            double *channels[2]{};
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch] = buffer.getWritePointer(ch, pos);
+            AudioBuffer<double> subBuffer(channels, numChannels, numSamples);
+
+            refreshParams();
+
+            dsp::AudioBlock<double> block(subBuffer);
+            const auto state = getBlockState(mono);
+            const bool shouldBypass = pushDry(block, state);
+            processFrontEnd(subBuffer, state);
+            const bool spilled = scratch[frontScratch].takeOverflow();
+            processBackEnd(subBuffer, state, shouldBypass, spilled);
+        }
+    }
+
+    void refreshParams()
+    {
+        /* only re-read what changed since the last (sub-)block */
+        if (paramCache.refresh() &
+            (ParamCache::bit(ParamCache::inputGain) |
+             ParamCache::bit(ParamCache::outputGain) |
+             ParamCache::bit(ParamCache::gainLink))) {
+            inGain_raw =
+                std::pow(10.f, paramCache[ParamCache::inputGain] * 0.05f);
+            outGain_raw =
+                std::pow(10.f, paramCache[ParamCache::outputGain] * 0.05f);
+            if (paramCache.getBool(ParamCache::gainLink))
+                outGain_raw *= 1.f / inGain_raw;
+        }
+    }
+
+    BlockState getBlockState(bool mono)
+    {
+        BlockState state;
+        state.mono = mono;
+        state.ms = paramCache.getBool(ParamCache::ms);
+        state.bypassed = paramCache.getBool(ParamCache::bypass);
+        /* create linear gain range btw ~0.1 - 10 */
+        state.stereoEmph =
+            mapToLog10(paramCache[ParamCache::stereoEmphasis], 0.1f, 10.f);
+        return state;
+    }
+
+    /* call whenever oversampling or the pipeline is reconfigured, the host
+     * only hears about it if the total moved */
+    void updateLatency()
+    {
+        latency.set(LatencyBudget::oversampling, getOversamplingLatency());
+        latency.set(LatencyBudget::pipeline,
+                    pipelined ? 2.0 * pipeBlockSize : 0.0);
+
+        /* dry path only needs to cover the oversampling latency, the
+         * pipeline delays dry & wet together */
+        const auto dryLatency = latency.get(LatencyBudget::oversampling);
+        mixDelay.setDelay(dryLatency);
+        dryDelay.setDelay((int)dryLatency);
+
+        if (latency.commit())
+            setLatencySamples(latency.getTotalSamples());
+    }
 
-        dsp::AudioBlock<double> block(buffer);
-        const size_t numChannels = mono ? 1 : block.getNumChannels();
+    /* push dry samples to the mix & bypass delays, returns whether the bypass
+     * path needs processing */
+    bool pushDry(const dsp::AudioBlock<double> &block, const BlockState &state)
+    {
+        const size_t numChannels = state.mono ? 1 : block.getNumChannels();
 
-        /* push dry samples to mixer */
         for (size_t ch = 0; ch < numChannels; ++ch) {
             const auto *in = block.getChannelPointer(ch);
             for (size_t i = 0; i < block.getNumSamples(); ++i)
                 mixDelay.pushSample(ch, in[i]);
         }
 
-        bool shouldBypass = processBypassIn(block, isBypassed, numChannels);
+        return processBypassIn(block, state.bypassed, numChannels);
+    }
+
+    /* input gain -> amp -> output emphasis -> cab */
+    void processFrontEnd(AudioBuffer<double> &buffer, const BlockState &state)
+    {
+        const size_t os_index_ = os_index;
+        const bool mono = state.mono;
+        const bool ms = state.ms;
+
+        auto &arena = scratch[frontScratch];
+        Processors::ScratchArena::Scope scope(arena);
+        /* a mono layout only ever touches channel 0 */
+        const size_t numChannels = mono ? 1 : (size_t)buffer.getNumChannels();
+        auto block = dsp::AudioBlock<double>(buffer).getSubsetChannelBlock(
+            0, numChannels);
 
         // if (*gate > -95.0)
         //     gateProc.process(dsp::ProcessContextReplacing<double>(block));
@@ -226,98 +364,97 @@ class GammaAudioProcessor : public juce::AudioProcessor,
                                                   lastInGain);
 
         /* M/S encode if necessary */
-        bool ms = (bool)*apvts.getRawParameterValue("m/s");
         if (ms && !mono)
             strix::MSMatrix::msEncode(block);
 
         /* Input Stereo Emphasis */
-        float stereoEmph = *apvts.getRawParameterValue("stereoEmphasis");
-        if (!mono) {
-            stereoEmph =
-                mapToLog10(stereoEmph, 0.1f,
-                           10.f); /* create linear gain range btw ~0.1 - 10 */
-            emphasisIn.process(block, stereoEmph, ms);
+        if (!mono)
+            emphasisIn.process(block, state.stereoEmph, ms);
+
+        emphFilters.processIn(block);
+
+        const auto p_comp = paramCache[ParamCache::comp];
+        const auto linked = paramCache.getBool(ParamCache::compLink);
+        const auto compPos = paramCache.getBool(ParamCache::compPos);
+        const auto ampOn = paramCache.getBool(ParamCache::ampOn);
+
+        // keep the amp-off path around while fading
+        ampFade.setTarget(ampOn);
+        const bool ampFading = ampFade.isFading();
+        const bool ampActive = ampOn || ampFading;
+        const bool cabOn = paramCache[ParamCache::cabType] > 0.f;
+        /* the 1x "oversampler" is a passthrough copy, skip it */
+        const bool baseRate = os_index_ == osOff;
+        auto &comp = getActiveAmp().comp;
+
+#if USE_SIMD
+        /* with nothing planar between them, amp -> fade -> emphasis out ->
+         * cab stay interleaved end to end */
+        if (baseRate && ampActive && cabOn && !(compPos && p_comp != 0.f)) {
+            /* after the amp it's at 0 here, so it only needs resetting */
+            if (compPos)
+                comp.bypass();
+            else
+                comp.processBlock(block, p_comp, linked);
+            auto ampBlock = simd.interleaveBlock(arena, block);
+            auto ampOff = ampFading ? arena.copyOf(ampBlock) : ampBlock;
+            processAmp(ampBlock);
+            if (ampFading)
+                ampFade.process(ampOff, ampBlock, ampBlock);
+            emphFilters.processOut(ampBlock);
+            cab.processBlock(ampBlock);
+            simd.deinterleaveBlock(ampBlock, block);
+            return;
         }
+#endif
+
+        /* only the amp's nonlinear stages run oversampled, the compressor
+         * either side of it stays at the base rate */
+        if (!compPos)
+            comp.processBlock(block, p_comp, linked);
 
-        emphLow.processIn(block);
-        emphHigh.processIn(block);
-
-        const auto p_comp = apvts.getRawParameterValue("comp")->load();
-        const auto linked =
-            (bool)apvts.getRawParameterValue("compLink")->load();
-        const auto compPos =
-            (bool)apvts.getRawParameterValue("compPos")->load();
-        const auto ampOn = (bool)apvts.getRawParameterValue("ampOn")->load();
-
-        // load buffers for crossfade if needed
-        if (ampOn != lastAmpOn)
-            preAmpCrossfade.reset();
-        if (!preAmpCrossfade.complete) {
-            preAmpBuf.makeCopyOf(buffer, true);
+        dsp::AudioBlock<double> ampOff;
+        if (ampFading) {
+            ampOff = Processors::Crossfader::getScratch(arena, numChannels,
+                                                        block.getNumSamples());
+            ampOff.copyFrom(block);
         }
 
         /* main processing */
-        auto osBlock = oversample[os_index_].processSamplesUp(block);
+        auto osBlock = block;
+        if (os_index_ == osMinPhase)
+            osBlock = minPhaseOS.processSamplesUp(block);
+        else if (!baseRate)
+            osBlock = oversample[os_index_].processSamplesUp(block);
         if (mono)
             osBlock = osBlock.getSingleChannelBlock(0);
 
-        switch (currentMode) {
-        case Guitar:
-            if (!compPos)
-                guitar.comp.processBlock(osBlock, p_comp, linked);
-            if (ampOn || !preAmpCrossfade.complete) {
-                guitar.processBlock(osBlock);
-                osBlock.multiplyBy(Decibels::decibelsToGain(-18.0));
-            }
-            if (compPos)
-                guitar.comp.processBlock(osBlock, p_comp, linked);
-            break;
-        case Bass:
-            if (!compPos)
-                bass.comp.processBlock(osBlock, p_comp, linked);
-            if (ampOn || !preAmpCrossfade.complete) {
-                bass.processBlock(osBlock);
-                osBlock.multiplyBy(Decibels::decibelsToGain(-10.0));
-            }
-            if (compPos)
-                bass.comp.processBlock(osBlock, p_comp, linked);
-            break;
-        case Channel:
-            if (!compPos)
-                channel.comp.processBlock(osBlock, p_comp, linked);
-            if (ampOn || !preAmpCrossfade.complete)
-                channel.processBlock(osBlock);
-            if (compPos)
-                channel.comp.processBlock(osBlock, p_comp, linked);
-            break;
+        if (ampActive) {
+#if USE_SIMD
+            auto ampBlock = simd.interleaveBlock(arena, osBlock);
+            processAmp(ampBlock);
+            simd.deinterleaveBlock(ampBlock);
+#else
+            processAmp(osBlock);
+#endif
         }
-
-        oversample[os_index_].processSamplesDown(block);
+        if (os_index_ == osMinPhase)
+            minPhaseOS.processSamplesDown(block);
+        else if (!baseRate)
+            oversample[os_index_].processSamplesDown(block);
 
         // perform crossfade if needed
-        if (!preAmpCrossfade.complete) {
-            if (ampOn) // fade to processed block
-                preAmpCrossfade.processWithState(preAmpBuf, buffer,
-                                                 buffer.getNumSamples());
-            else // fade to pre-amp block
-            {
-                preAmpCrossfade.processWithState(buffer, preAmpBuf,
-                                                 buffer.getNumSamples());
-                buffer.makeCopyOf(preAmpBuf, true);
-            }
-        }
+        if (ampFading)
+            ampFade.process(ampOff, block, block);
 
-        lastAmpOn = ampOn;
+        if (compPos)
+            comp.processBlock(block, p_comp, linked);
 
-        auto latency = oversample[os_index_].getLatencyInSamples();
-        setLatencySamples((int)latency);
+        emphFilters.processOut(block);
 
-        emphLow.processOut(block);
-        emphHigh.processOut(block);
-
-        if ((bool)*apvts.getRawParameterValue("cabType")) {
+        if (cabOn) {
 #if USE_SIMD
-            auto &&processBlock = simd.interleaveBlock(block);
+            auto &&processBlock = simd.interleaveBlock(arena, block);
 #else
             auto &&processBlock = block;
 #endif
@@ -326,30 +463,77 @@ class GammaAudioProcessor : public juce::AudioProcessor,
             simd.deinterleaveBlock(processBlock);
 #endif
         }
+    }
+
+    Processors::Processor &getActiveAmp()
+    {
+        switch (currentMode) {
+        case Guitar:
+            return guitar;
+        case Bass:
+            return bass;
+        default:
+            return channel;
+        }
+    }
+
+    template <typename Block> void processAmp(Block &ampBlock)
+    {
+        switch (currentMode) {
+        case Guitar:
+            guitar.processBlock(ampBlock);
+            ampBlock.multiplyBy(Decibels::decibelsToGain(-18.0));
+            break;
+        case Bass:
+            bass.processBlock(ampBlock);
+            ampBlock.multiplyBy(Decibels::decibelsToGain(-10.0));
+            break;
+        case Channel:
+            channel.processBlock(ampBlock);
+            break;
+        }
+    }
+
+    /* reverb -> enhancers -> output, at the base rate */
+    /* frontSpilled: the front end ran out of scratch, so the wet signal is
+     * garbage & only the delayed dry goes out */
+    void processBackEnd(AudioBuffer<double> &buffer, const BlockState &state,
+                        bool shouldBypass, bool frontSpilled)
+    {
+        const bool mono = state.mono;
+        const bool ms = state.ms;
+
+        Processors::ScratchArena::Scope scope(scratch[backScratch]);
+        const size_t numChannels = mono ? 1 : (size_t)buffer.getNumChannels();
+        auto block = dsp::AudioBlock<double>(buffer).getSubsetChannelBlock(
+            0, numChannels);
 
         /* Output Stereo Emphasis */
         if (!mono)
-            emphasisOut.process(block, 1.f / stereoEmph, ms);
+            emphasisOut.process(block, 1.f / state.stereoEmph, ms);
 
         if (ms && !mono)
             strix::MSMatrix::msDecode(block);
 
         /* doubler */
-        double dubAmt = *apvts.getRawParameterValue("doubler");
+        double dubAmt = paramCache[ParamCache::doubler];
         if ((bool)dubAmt && !mono)
             doubler.process(block, dubAmt);
 
-        reverb.process(buffer, *apvts.getRawParameterValue("reverbAmt"));
-
-        if ((bool)*lfEnhance)
-            lfEnhancer.processBlock(
-                block, (double)*lfEnhance,
-                *apvts.getRawParameterValue("lfEnhanceInvert"), mono);
-
-        if ((bool)*hfEnhance)
-            hfEnhancer.processBlock(
-                block, (double)*hfEnhance,
-                *apvts.getRawParameterValue("hfEnhanceInvert"), mono);
+        AudioBuffer<double> wet(buffer.getArrayOfWritePointers(),
+                                (int)numChannels, buffer.getNumSamples());
+        reverb.process(wet, paramCache[ParamCache::reverbAmt]);
+
+        /* both enhancers run in one pass, the LF one feeding the HF one */
+        const auto n = block.getNumSamples();
+        const bool lfOn = lfEnhancer.prepareBlock(
+            paramCache[ParamCache::lfEnhance],
+            paramCache.getBool(ParamCache::lfEnhanceInvert), n);
+        const bool hfOn = hfEnhancer.prepareBlock(
+            paramCache[ParamCache::hfEnhance],
+            paramCache.getBool(ParamCache::hfEnhanceInvert), n);
+        Processors::Enhancers::process(block, lfEnhancer, lfOn, hfEnhancer,
+                                       hfOn);
 
         // final cut filters
         cutFilters.process(block);
@@ -358,17 +542,17 @@ class GammaAudioProcessor : public juce::AudioProcessor,
         strix::SmoothGain<float>::applySmoothGain(block, outGain_raw,
                                                   lastOutGain);
 
-        float width = *apvts.getRawParameterValue("width");
+        float width = paramCache[ParamCache::width];
         if (width != 1.f && !mono)
             strix::Balance::processBalance(block, width, false, lastWidth);
 
-        mixDelay.setDelay(latency);
-        dryDelay.setDelay((int)latency);
-        float mixAmt = *apvts.getRawParameterValue("mix");
+        float mixAmt = paramCache[ParamCache::mix];
         if (mixAmt != sm_mix.getCurrentValue())
             sm_mix.setTargetValue(mixAmt);
+        const bool spilled =
+            frontSpilled || scratch[backScratch].takeOverflow();
         for (size_t i = 0; i < block.getNumSamples(); ++i) {
-            float mix = sm_mix.getNextValue();
+            float mix = spilled ? 0.f : sm_mix.getNextValue();
             for (size_t ch = 0; ch < numChannels; ++ch) {
                 auto out = block.getChannelPointer(ch);
                 out[i] = ((1.f - mix) * mixDelay.popSample(ch)) + mix * out[i];
@@ -377,16 +561,115 @@ class GammaAudioProcessor : public juce::AudioProcessor,
 
         /* manage bypass */
         if (shouldBypass)
-            processBypassOut(block, isBypassed, numChannels);
-        lastBypass = isBypassed;
+            processBypassOut(block, state.bypassed, numChannels);
     }
 
+    /**
+     * Offline render pipeline. Host audio is re-blocked into fixed
+     * pipeBlockSize chunks; the front end of chunk N runs on pipeWorker
+     * while the back end of chunk N-1 runs here, which costs two chunks of
+     * latency.
+     */
+    struct PipelineSlot
+    {
+        AudioBuffer<double> audio, dry;
+        BlockState state;
+        bool primed = false, spilled = false;
+    };
+
+    void preparePipeline(int blockSize, int numChannels)
+    {
+        pipelined = isNonRealtime() && blockSize >= minPipelineBlockSize;
+        if (!pipelined) {
+            pipeWorker.stop();
+            return;
+        }
+
+        pipeBlockSize = blockSize;
+        for (auto &slot : pipeSlots) {
+            slot.audio.setSize(numChannels, blockSize);
+            slot.dry.setSize(numChannels, blockSize);
+            slot.dry.clear();
+            slot.primed = false;
+        }
+        pipeOut.setSize(numChannels, blockSize);
+        pipeOut.clear();
+        pipePos = 0;
+        pipeFill = 0;
+        pipeWorker.start();
+    }
+
+    void processPipelined(AudioBuffer<double> &buffer, bool mono)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels =
+            jmin(buffer.getNumChannels(), pipeOut.getNumChannels());
+        int pos = 0;
+
+        while (pos < numSamples) {
+            const int n = jmin(numSamples - pos, pipeBlockSize - pipePos);
+            auto &fill = pipeSlots[pipeFill];
+            for (int ch = 0; ch < numChannels; ++ch) {
+                fill.dry.copyFrom(ch, pipePos, buffer, ch, pos, n);
+                buffer.copyFrom(ch, pos, pipeOut, ch, pipePos, n);
+            }
+            pipePos += n;
+            pos += n;
+
+            if (pipePos == pipeBlockSize) {
+                advancePipeline(mono);
+                pipePos = 0;
+            }
+        }
+    }
+
+    void advancePipeline(bool mono)
+    {
+        auto &front = pipeSlots[pipeFill];
+        auto &back = pipeSlots[1 - pipeFill];
+
+        refreshParams();
+
+        front.state = getBlockState(mono);
+        front.audio.makeCopyOf(front.dry, true);
+
+        auto frontJob = [&] {
+            processFrontEnd(front.audio, front.state);
+            front.spilled = scratch[frontScratch].takeOverflow();
+        };
+        pipeWorker.dispatch(frontJob);
+
+        if (back.primed) {
+            dsp::AudioBlock<double> dry(back.dry);
+            const bool shouldBypass = pushDry(dry, back.state);
+            processBackEnd(back.audio, back.state, shouldBypass,
+                           back.spilled);
+            pipeOut.makeCopyOf(back.audio, true);
+        } else
+            pipeOut.clear();
+
+        pipeWorker.waitForJob();
+
+        front.primed = true;
+        pipeFill = 1 - pipeFill;
+    }
+
+    static constexpr int minPipelineBlockSize = 1024;
+    bool pipelined = false;
+    int pipeBlockSize = 0, pipePos = 0, pipeFill = 0;
+    std::array<PipelineSlot, 2> pipeSlots;
+    AudioBuffer<double> pipeOut;
+    Processors::Worker pipeWorker{"OmniAmp Pipeline"};
+    /* shared by the stages that can split L & R across threads */
+    Processors::Worker channelWorker{"OmniAmp Channels"};
+
     inline float calcBassParam(float val) { return val * val * val; }
 
     inline bool processBypassIn(const dsp::AudioBlock<double> &block,
                                 const bool byp, const size_t numChannels)
     {
-        if (!byp && !lastBypass)
+        bypassFade.setTarget(byp);
+        if (!byp && !bypassFade.isFading())
             return false;
 
         for (size_t ch = 0; ch < numChannels; ++ch) {
@@ -397,37 +680,26 @@ class GammaAudioProcessor : public juce::AudioProcessor,
         return true;
     }
 
+    /* the bypass fade runs over a fixed number of samples, carried across
+     * blocks, so it doesn't shrink when the host splits blocks at events */
     inline void processBypassOut(dsp::AudioBlock<double> &block, const bool byp,
                                  const size_t numChannels)
     {
-        if (lastBypass && byp) // bypass
-        {
+        const bool fading = bypassFade.isFading();
+        auto out = block.getSubsetChannelBlock(0, numChannels);
+        auto dry = fading ? Processors::Crossfader::getScratch(
+                                scratch[backScratch], numChannels,
+                                block.getNumSamples())
+                          : out; // fully bypassed, pop straight to output
+
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            auto *d = dry.getChannelPointer(ch);
             for (size_t i = 0; i < block.getNumSamples(); ++i)
-                for (size_t ch = 0; ch < numChannels; ++ch)
-                    block.getChannelPointer(ch)[i] = dryDelay.popSample(ch);
-        } else if (byp && !lastBypass) // fade-in dry
-        {
-            float inc = 1.f / (float)block.getNumSamples();
-            float gain = 0.f;
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                for (size_t ch = 0; ch < numChannels; ++ch)
-                    block.getChannelPointer(ch)[i] =
-                        (dryDelay.popSample(ch) * gain) +
-                        (block.getChannelPointer(ch)[i] * (1.f - gain));
-                gain += inc;
-            }
-        } else if (!byp && lastBypass) // fade-out dry
-        {
-            float inc = 1.f / (float)block.getNumSamples();
-            float gain = 0.f;
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                for (size_t ch = 0; ch < numChannels; ++ch)
-                    block.getChannelPointer(ch)[i] =
-                        (dryDelay.popSample(ch) * (1.f - gain)) +
-                        (block.getChannelPointer(ch)[i] * gain);
-                gain += inc;
-            }
+                d[i] = dryDelay.popSample(ch);
         }
+
+        if (fading)
+            bypassFade.process(out, dry, out);
     }
 
     void checkLicense()
@@ -31,7 +31,7 @@ struct PresetManager : private AudioProcessorValueTreeState::Listener
 
         for (auto *param : apvts.processor.getParameters()) {
             if (const auto p = dynamic_cast<RangedAudioParameter *>(param))
-                if (p->paramID != "hq" && p->paramID != "renderHQ")
+                if (!isSessionSetting(p->paramID))
                     apvts.addParameterListener(p->paramID, this);
         }
     }
@@ -40,11 +40,19 @@ struct PresetManager : private AudioProcessorValueTreeState::Listener
     {
         for (auto *param : apvts.processor.getParameters()) {
             if (const auto p = dynamic_cast<RangedAudioParameter *>(param))
-                if (p->paramID != "hq" && p->paramID != "renderHQ")
+                if (!isSessionSetting(p->paramID))
                     apvts.removeParameterListener(p->paramID, this);
         }
     }
 
+    /* settings that belong to the session rather than the sound, presets
+     * neither mark them as changes nor load them */
+    static bool isSessionSetting(const String &paramID)
+    {
+        return paramID == "hq" || paramID == "renderHQ" ||
+               paramID == "hqLowLatency" || paramID == "fastDiodes";
+    }
+
     void parameterChanged(const String &, float)
     {
         if (!stateChanged)
@@ -142,6 +150,16 @@ struct PresetManager : private AudioProcessorValueTreeState::Listener
         else
             jassertfalse;
 
+        // presets saved before these existed don't have them
+        for (auto *id : {"hqLowLatency", "fastDiodes"}) {
+            auto current = apvts.state.getChildWithProperty("id", id);
+            auto loaded = newstate.getChildWithProperty("id", id);
+            if (loaded.isValid())
+                loaded.copyPropertiesFrom(current, nullptr);
+            else if (current.isValid())
+                newstate.appendChild(current.createCopy(), nullptr);
+        }
+
         // if (newBypass.isValid())
         //     newBypass.copyPropertiesFrom(bypass, nullptr);
         // else
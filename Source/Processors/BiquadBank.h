@@ -0,0 +1,72 @@
+/**
+ * BiquadBank.h
+ * Fixed filters that always run together, sharing coefficients across
+ * channels
+ */
+
+#pragma once
+
+/* normalised biquad, first-order sections leave b2 = a2 = 0 */
+struct BiquadCoeffs
+{
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+
+    /* from dsp::IIR::ArrayCoefficients' {b0, b1, (b2), a0, a1, (a2)} */
+    template <size_t N> static BiquadCoeffs from(const std::array<double, N> &c)
+    {
+        static_assert(N == 4 || N == 6, "first or second order only");
+        BiquadCoeffs r;
+        if constexpr (N == 6) {
+            const auto g = 1.0 / c[3];
+            r.b0 = c[0] * g;
+            r.b1 = c[1] * g;
+            r.b2 = c[2] * g;
+            r.a1 = c[4] * g;
+            r.a2 = c[5] * g;
+        } else {
+            const auto g = 1.0 / c[2];
+            r.b0 = c[0] * g;
+            r.b1 = c[1] * g;
+            r.a1 = c[3] * g;
+        }
+        return r;
+    }
+
+    /* transposed direct form II */
+    template <typename V> inline V process(V x, V &s1, V &s2) const
+    {
+        const V y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+/**
+ * One set of coefficients per section, shared by every channel, & a state
+ * pair per channel & section. The sections are called inline from the
+ * caller's own per-sample loop, so a chain of them stays in registers. With
+ * T = vec a "channel" is an interleaved vec channel, holding L & R.
+ */
+template <typename T, size_t numSections, size_t numChannels = 2>
+struct BiquadBank
+{
+    void set(size_t section, const BiquadCoeffs &c) { coeffs[section] = c; }
+
+    void reset()
+    {
+        for (auto &ch : state)
+            for (auto &s : ch)
+                s[0] = s[1] = 0.0;
+    }
+
+    inline T process(size_t section, size_t ch, T x)
+    {
+        auto &s = state[ch][section];
+        return coeffs[section].process(x, s[0], s[1]);
+    }
+
+  private:
+    std::array<BiquadCoeffs, numSections> coeffs;
+    std::array<std::array<std::array<T, 2>, numSections>, numChannels> state{};
+};
@@ -201,11 +201,7 @@ template <typename Type> class FDNCab : AudioProcessorValueTreeState::Listener
 
     FDN<Type> fdn;
 
-#if USE_SIMD
-    strix::Buffer<Type> apBuffer;
-#else
-    AudioBuffer<Type> apBuffer;
-#endif
+    ScratchArena *arena = nullptr;
 
     CabType type;
 
@@ -250,6 +246,8 @@ template <typename Type> class FDNCab : AudioProcessorValueTreeState::Listener
             setParams();
     }
 
+    void setArena(ScratchArena *a) { arena = a; }
+
     void setCabType()
     {
         auto newType = type_p->getIndex();
@@ -267,8 +265,6 @@ template <typename Type> class FDNCab : AudioProcessorValueTreeState::Listener
     {
         sr = spec.sampleRate;
 
-        apBuffer.setSize(spec.numChannels, spec.maximumBlockSize);
-
         fdn.prepare(spec);
         setCabType();
 
@@ -357,11 +353,8 @@ template <typename Type> class FDNCab : AudioProcessorValueTreeState::Listener
             }
         }
 
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
-            apBuffer.copyFrom(ch, 0, block.getChannelPointer(ch),
-                              block.getNumSamples());
-
-        auto apBlock = Block(apBuffer).getSubBlock(0, block.getNumSamples());
+        ScratchArena::Scope scope(*arena);
+        auto apBlock = arena->copyOf(block);
 
         ap.processBlock(apBlock);
         apBlock *= 0.2;
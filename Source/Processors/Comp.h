@@ -121,11 +121,17 @@ template <typename T> struct OptoComp
         }
     }
 
+    /* what a block at comp == 0 does: no gain reduction, nothing to carry */
+    void bypass()
+    {
+        grSource.measureGR(1.0);
+        reset();
+    }
+
     void processBlock(dsp::AudioBlock<double> &block, T comp, bool linked)
     {
         if (comp == 0.0) {
-            grSource.measureGR(1.0);
-            reset();
+            bypass();
             return;
         }
         if (block.getNumChannels() > 1 && linked)
@@ -0,0 +1,160 @@
+/**
+ * Crossfader.h
+ * Shared crossfade for amp, bypass & reverb transitions
+ */
+
+#pragma once
+
+/**
+ * Fades between two signal paths. The fade position moves toward a target
+ * path at a fixed rate and may reverse mid-fade. Path 0 is heard at
+ * position 0 and path 1 at position 1. The output may alias either input, so
+ * a stage can fade into the buffer it just processed without copying it
+ * back. Scratch for the path that would otherwise be overwritten comes from
+ * the caller's ScratchArena.
+ */
+struct Crossfader
+{
+    enum class Curve
+    {
+        Linear,     // for correlated paths (dry vs. processed)
+        EqualPower, // for uncorrelated paths (e.g. two reverbs)
+    };
+
+    /* no allocation, safe to call from the audio thread */
+    void setFadeTime(double sampleRate, float seconds)
+    {
+        inc = 1.0 / jmax(1.0, sampleRate * seconds);
+    }
+
+    void setCurve(Curve newCurve) { curve = newCurve; }
+
+    void setTarget(bool path1) { target = path1 ? 1.0 : 0.0; }
+
+    /* skip straight to a path, e.g. on prepare or after a state load */
+    void jumpTo(bool path1)
+    {
+        setTarget(path1);
+        pos = target;
+    }
+
+    /* start a new fade from path 0, whatever the current position */
+    void restart()
+    {
+        pos = 0.0;
+        target = 1.0;
+    }
+
+    bool isFading() const { return pos != target; }
+    double getPosition() const { return pos; }
+
+    /* scratch for one path, valid until the arena's enclosing Scope ends */
+    static dsp::AudioBlock<double> getScratch(ScratchArena &arena,
+                                              size_t numChannels,
+                                              size_t numSamples)
+    {
+        return dsp::AudioBlock<double>(
+            arena.allocateChannels<double>(numChannels, numSamples),
+            numChannels, numSamples);
+    }
+
+    /* out = path0 * g0 + path1 * g1, advancing the fade position */
+    void process(const dsp::AudioBlock<double> &path0,
+                 const dsp::AudioBlock<double> &path1,
+                 dsp::AudioBlock<double> &out)
+    {
+        const auto numChannels = out.getNumChannels();
+        const auto numSamples = out.getNumSamples();
+        jassert(path0.getNumChannels() >= numChannels &&
+                path1.getNumChannels() >= numChannels);
+
+        const double step = target > pos ? inc : -inc;
+        size_t i = 0;
+
+        /* gains for vec::size samples at a time, shared by every channel */
+        constexpr auto width = vec::size;
+        alignas(64) double iota[width];
+        for (size_t n = 0; n < width; ++n)
+            iota[n] = (double)n;
+        const auto offsets = xsimd::load_aligned(iota);
+
+        for (; i + width <= numSamples; i += width) {
+            auto t = xsimd::clip(pos + step * ((double)i + offsets), vec(0.0),
+                                 vec(1.0));
+            vec g0, g1;
+            gains(t, g0, g1);
+
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                auto x0 =
+                    xsimd::load_unaligned(path0.getChannelPointer(ch) + i);
+                auto x1 =
+                    xsimd::load_unaligned(path1.getChannelPointer(ch) + i);
+                xsimd::store_unaligned(out.getChannelPointer(ch) + i,
+                                       x0 * g0 + x1 * g1);
+            }
+        }
+
+        for (; i < numSamples; ++i) {
+            auto t = jlimit(0.0, 1.0, pos + step * (double)i);
+            double g0, g1;
+            gains(t, g0, g1);
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                out.getChannelPointer(ch)[i] =
+                    path0.getChannelPointer(ch)[i] * g0 +
+                    path1.getChannelPointer(ch)[i] * g1;
+        }
+
+        advance(step, numSamples);
+    }
+
+#if USE_SIMD
+    /* interleaved variant, every lane of a sample shares its gains */
+    void process(strix::AudioBlock<vec> &path0, strix::AudioBlock<vec> &path1,
+                 strix::AudioBlock<vec> &out)
+    {
+        const auto numSamples = out.getNumSamples();
+        const double step = target > pos ? inc : -inc;
+
+        for (size_t i = 0; i < numSamples; ++i) {
+            double g0, g1;
+            gains(jlimit(0.0, 1.0, pos + step * (double)i), g0, g1);
+
+            for (size_t ch = 0; ch < out.getNumChannels(); ++ch)
+                out.getChannelPointer(ch)[i] =
+                    path0.getChannelPointer(ch)[i] * g0 +
+                    path1.getChannelPointer(ch)[i] * g1;
+        }
+
+        advance(step, numSamples);
+    }
+#endif
+
+  private:
+    void advance(double step, size_t numSamples)
+    {
+        pos = jlimit(0.0, 1.0, pos + step * (double)numSamples);
+        /* land exactly on the target so isFading() settles */
+        if (std::abs(pos - target) < inc * 0.5)
+            pos = target;
+    }
+
+    template <typename T> void gains(const T &t, T &g0, T &g1) const
+    {
+        if (curve == Curve::Linear) {
+            g0 = 1.0 - t;
+            g1 = t;
+            return;
+        }
+        using std::cos;
+        using std::sin;
+        using xsimd::cos;
+        using xsimd::sin;
+        const auto phase = t * MathConstants<double>::halfPi;
+        g0 = cos(phase);
+        g1 = sin(phase);
+    }
+
+    Curve curve = Curve::Linear;
+    double pos = 0.0, target = 0.0, inc = 1.0 / 512.0;
+};
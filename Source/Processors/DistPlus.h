@@ -3,24 +3,36 @@
 #pragma once
 namespace WDFT = chowdsp::wdft;
 
+/**
+ * MXR Distortion+ style pedal. In SIMD builds each lane of a vec is a channel
+ * running through one circuit; the scalar build keeps a circuit per channel.
+ */
 template <typename T> class MXRDistWDF
 {
   public:
     // whether or not the process method will call an init method within itself
     bool init = true;
 
+    /* R3, and with it the R-type adaptor's scattering matrix, follows the
+     * smoothed dist control in steps of this many samples */
+    static constexpr size_t paramInterval = 16;
+
+#if USE_SIMD
+    static constexpr size_t numCircuits = 1;
+#else
+    static constexpr size_t numCircuits = 2;
+#endif
+
     MXRDistWDF() = default;
 
     void prepare(const dsp::ProcessSpec &spec)
     {
         SR = spec.sampleRate;
-        C1.prepare((T)SR);
-        C2.prepare((T)SR);
-        C3.prepare((T)SR);
-        C4.prepare((T)SR);
-        C5.prepare((T)SR);
-
-        Vb.setVoltage((T)4.5f);
+        for (auto &c : circuits)
+            c.prepare((T)SR);
+        rateData = &getRateData(circuits[0], SR);
+        for (auto &c : circuits)
+            c.setCapacitorStates(rateData->settled);
 
         dist.reset(SR, 0.01);
         updateParams();
@@ -29,204 +41,176 @@ template <typename T> class MXRDistWDF
         dcBlock.setCutoffFreq(10.0);
         dcBlock.setType(strix::FilterType::highpass);
 
-        dry.setSize(spec.numChannels, spec.maximumBlockSize);
-        for (size_t i = 0; i < spec.maximumBlockSize; i++) {
-            processInit(0.5);
-        }
-
         setInit(true);
     }
 
     /*set the target value for the distortion param*/
     void setParams(double distParam) { dist.setTargetValue(distParam); }
 
-    /*update the distortion param from smoothed value*/
-    void updateParams()
+    /*update the distortion param from smoothed value, numSamples on*/
+    void updateParams(int numSamples = 1)
     {
-        ResDist_R3.setResistanceValue(dist.getNextValue() * rDistVal + R3Val);
+        const auto position = dist.skip(numSamples);
+        ImpedanceCalc::table = &rateData->table;
+        ImpedanceCalc::position = position;
+        for (auto &c : circuits)
+            c.ResDist_R3.setResistanceValue((T)(position * rDistVal + R3Val));
+        ImpedanceCalc::table = nullptr;
     }
 
-    void setInit(bool isInit)
+    /**
+     * Best refines the Wright omega estimate with a Newton step, Good skips
+     * it. Message thread, with processing suspended.
+     */
+    void setDiodeQuality(WDFT::DiodeQuality newQuality)
     {
-        init = isInit;
-        fade.setFadeTime(SR, 0.5f);
+        quality = newQuality;
+        for (auto &c : circuits)
+            c.setDiodeQuality(newQuality);
     }
 
-    inline T processSample(T x)
-    {
-        Vin.setVoltage(x);
-
-        DP.incident(P3.reflected());
-        P3.incident(DP.reflected());
+    void setArena(ScratchArena *a) { arena = a; }
 
-        return WDFT::voltage<T>(Rout);
-    }
-
-#if !USE_SIMD
-    /*for reg doubles currently just one channel, copies L->R*/
-    void processBlock(dsp::AudioBlock<T> &block)
+    void setInit(bool isInit)
     {
-        auto *inL = block.getChannelPointer(0);
-        FloatVectorOperations::copy(dry.getWritePointer(0), inL,
-                                    block.getNumSamples());
-        auto *inR = inL;
-        if (block.getNumChannels() > 1) {
-            inR = block.getChannelPointer(1);
-            FloatVectorOperations::copy(dry.getWritePointer(1), inR,
-                                        block.getNumSamples());
-        }
-        dsp::AudioBlock<T> dryBlock(dry.getArrayOfWritePointers(),
-                                    block.getNumChannels(),
-                                    block.getNumSamples());
-
-        if (dist.isSmoothing()) {
-            for (auto i = 0; i < block.getNumSamples(); ++i) {
-                updateParams();
-                inL[i] = processSample(inL[i]);
-            }
-            FloatVectorOperations::copy(inR, inL, block.getNumSamples());
-            if (init) {
-                fade.processWithState(
-                    dryBlock, block,
-                    jmin(block.getNumSamples(), dryBlock.getNumSamples()));
-                if (fade.complete)
-                    init = false;
-            }
-            dcBlock.processBlock(block);
-            return;
-        }
-
-        updateParams();
-
-        for (auto i = 0; i < block.getNumSamples(); ++i) {
-            inL[i] = processSample(inL[i]);
-        }
-        FloatVectorOperations::copy(inR, inL, block.getNumSamples());
-        if (init) {
-            fade.processWithState(
-                dryBlock, block,
-                jmin(block.getNumSamples(), dryBlock.getNumSamples()));
-            if (fade.complete)
-                init = false;
-        }
-        dcBlock.processBlock(block);
+        init = isInit;
+        fade.setFadeTime(SR, 0.5f);
     }
 
-    void processBlockInit(dsp::AudioBlock<T> &block)
+    template <typename Block> void processBlock(Block &block)
     {
-        auto *in = block.getChannelPointer(0);
+        ScratchArena::Scope scope(*arena);
+        const auto numSamples = block.getNumSamples();
+        /* the dry copy only feeds the fade-in after a reset */
+        auto dryBlock = init ? arena->copyOf(block) : block;
 
-        updateParams();
-        for (size_t i = 0; i < block.getNumSamples(); ++i) {
-            processInit(in[i]);
-        }
-    }
-#else
-    void processBlock(strix::AudioBlock<T> &block)
-    {
-        auto *in = block.getChannelPointer(0);
-        memcpy(dry.getWritePointer(0), in, sizeof(T) * block.getNumSamples());
-        strix::AudioBlock<T> dryBlock(dry.getArrayOfWritePointers(),
-                                      block.getNumChannels(),
-                                      block.getNumSamples());
         if (dist.isSmoothing()) {
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                updateParams();
-                in[i] = processSample(in[i]);
-            }
-            if (init) {
-                fade.processWithState(
-                    dryBlock, block,
-                    jmin(block.getNumSamples(), dryBlock.getNumSamples()));
-                if (fade.complete)
-                    init = false;
+            for (size_t start = 0; start < numSamples;
+                 start += paramInterval) {
+                const auto n = jmin(paramInterval, numSamples - start);
+                updateParams((int)n);
+                processCircuits(block, start, n);
             }
-            dcBlock.processBlock(block);
-            return;
+        } else {
+            updateParams();
+            processCircuits(block, 0, numSamples);
         }
 
-        updateParams();
-
-        for (size_t i = 0; i < block.getNumSamples(); ++i) {
-            in[i] = processSample(in[i]);
-        }
         if (init) {
-            fade.processWithState(
-                dryBlock, block,
-                jmin(block.getNumSamples(), dryBlock.getNumSamples()));
+            fade.processWithState(dryBlock, block,
+                                  jmin(numSamples, dryBlock.getNumSamples()));
             if (fade.complete)
                 init = false;
         }
         dcBlock.processBlock(block);
     }
 
-    void processBlockInit(strix::AudioBlock<T> &block)
+    template <typename Block> void processBlockInit(Block &block)
     {
-        auto *in = block.getChannelPointer(0);
-
         updateParams();
-        for (size_t i = 0; i < block.getNumSamples(); ++i) {
-            processInit(in[i]);
+        const auto numCh = jmin(block.getNumChannels(), numCircuits);
+        for (size_t ch = 0; ch < numCh; ++ch) {
+            auto *in = block.getChannelPointer(ch);
+            for (size_t i = 0; i < block.getNumSamples(); ++i)
+                circuits[ch].processInit(in[i]);
         }
     }
 
-#endif
   private:
-    // propagate signal without returning anything
-    inline void processInit(T x)
+    template <typename Block>
+    void processCircuits(Block &block, size_t start, size_t numSamples)
     {
-        Vin.setVoltage(x);
-
-        DP.incident(P3.reflected());
-        P3.incident(DP.reflected());
-        // dcBlock.processSample(0, x);
-        // dcBlock.processSample(1, x);
+        const auto numCh = jmin(block.getNumChannels(), numCircuits);
+        for (size_t ch = 0; ch < numCh; ++ch) {
+            auto *x = block.getChannelPointer(ch) + start;
+            auto &c = circuits[ch];
+            /* the quality only changes while suspended, so branch once */
+            if (quality == WDFT::DiodeQuality::Best) {
+                for (size_t i = 0; i < numSamples; ++i)
+                    x[i] = c.processSample(x[i], c.DPBest);
+            } else {
+                for (size_t i = 0; i < numSamples; ++i)
+                    x[i] = c.processSample(x[i], c.DPGood);
+            }
+        }
     }
 
     double SR = 44100.0;
 
-#if USE_SIMD
-    strix::Buffer<T> dry;
-#else
-    AudioBuffer<T> dry;
-#endif
+    ScratchArena *arena = nullptr;
     strix::Crossfade fade;
 
-    // Port A
-    WDFT::ResistorT<T> R4{1.0e6f};
+    static constexpr float R3Val = 4.7e3f;
+    static constexpr float rDistVal = 1.0e6f;
+
+    using Matrix = T[4][4];
 
-    // Port B
-    WDFT::ResistiveVoltageSourceT<T> Vin;
-    WDFT::CapacitorT<T> C1{1.0e-9f};
-    WDFT::WDFParallelT<T, decltype(Vin), decltype(C1)> P1{Vin, C1};
+    /**
+     * The R-type adaptor's scattering matrix & upward impedance over the
+     * pot's travel. Only R3 & C3 change Rc, so the table holds for a sample
+     * rate. The matrix moves fastest at low resistances, so the table is
+     * spaced in sqrt(position) to put more points there.
+     */
+    struct ScatteringTable
+    {
+        static constexpr size_t size = 64;
 
-    WDFT::ResistorT<T> R1{10.0e3f};
-    WDFT::CapacitorT<T> C2{10.0e-9f};
-    WDFT::WDFSeriesT<T, decltype(R1), decltype(C2)> S1{R1, C2};
+        struct Entry
+        {
+            Matrix S;
+            T Rd;
+        };
 
-    WDFT::WDFSeriesT<T, decltype(S1), decltype(P1)> S2{S1, P1};
-    WDFT::ResistiveVoltageSourceT<T> Vb{1.0e6f}; // encompasses R2
-    WDFT::WDFParallelT<T, decltype(Vb), decltype(S2)> P2{Vb, S2};
+        static double toPosition(size_t index)
+        {
+            const auto u = (double)index / (double)size;
+            return u * u;
+        }
 
-    // Port C
-    static constexpr float R3Val = 4.7e3f;
-    static constexpr float rDistVal = 1.0e6f;
-    WDFT::ResistorT<T> ResDist_R3{rDistVal + R3Val}; // distortion potentiometer
-    WDFT::CapacitorT<T> C3{47.0e-9f};
-    WDFT::WDFSeriesT<T, decltype(ResDist_R3), decltype(C3)> S4{ResDist_R3, C3};
+        void lookup(double position, Matrix &S, T &Rd) const
+        {
+            const auto x = std::sqrt(jlimit(0.0, 1.0, position)) * size;
+            const auto k = jmin((size_t)x, size - 1);
+            const T f = x - (double)k;
+            const auto &a = entries[k], &b = entries[k + 1];
+            for (size_t i = 0; i < 4; ++i)
+                for (size_t j = 0; j < 4; ++j)
+                    S[i][j] = a.S[i][j] + f * (b.S[i][j] - a.S[i][j]);
+            Rd = a.Rd + f * (b.Rd - a.Rd);
+        }
+
+        std::array<Entry, size + 1> entries;
+    };
 
     struct ImpedanceCalc
     {
+        /* set around a pot change so the adaptor interpolates the table
+         * instead of solving; per thread, as every instance shares this */
+        static inline thread_local const ScatteringTable *table = nullptr;
+        static inline thread_local double position = 0.0;
+
         template <typename RType> static T calcImpedance(RType &R)
+        {
+            Matrix S;
+            T Rd;
+            if (table != nullptr) {
+                table->lookup(position, S, Rd);
+            } else {
+                const auto [Ra, Rb, Rc] = R.getPortImpedances();
+                Rd = solve(Ra, Rb, Rc, S);
+            }
+            R.setSMatrixData(S);
+            return Rd;
+        }
+
+        static T solve(T Ra, T Rb, T Rc, Matrix &S)
         {
             const T A = 100.0f;   // op-amp gain
             const T Ri = 1.0e9f;  // op-amp input impedance
             const T Ro = 1.0e-1f; // op-amp output impedance
 
-            const auto [Ra, Rb, Rc] = R.getPortImpedances();
-
-            R.setSMatrixData(
-                {{-(Ra * Ra * Rb * Rb + 2 * Ra * Ra * Rb * Rc +
+            const Matrix m = {
+                {-(Ra * Ra * Rb * Rb + 2 * Ra * Ra * Rb * Rc +
                     (Ra * Ra - Rb * Rb) * Rc * Rc -
                     ((A + 1) * Rc * Rc - Ra * Ra) * Ri * Ri -
                     ((A + 2) * Rb * Rc * Rc - 2 * Ra * Ra * Rb -
@@ -422,7 +406,8 @@ template <typename T> class MXRDistWDF
                   -(A * Ra * Ri + (Rb + Ri) * Ro) /
                       (Ra * Rb + (Ra + Rb) * Rc + ((A + 1) * Rc + Ra) * Ri -
                        (Rb + Rc + Ri) * Ro),
-                  0}});
+                  0}};
+            std::copy(&m[0][0], &m[0][0] + 16, &S[0][0]);
 
             const auto Rd = -(Ra * Rb + (Ra + Rb) * Rc + (Ra + Rc) * Ri) * Ro /
                             (Ra * Rb + (Ra + Rb) * Rc +
@@ -431,27 +416,173 @@ template <typename T> class MXRDistWDF
         }
     };
 
-    WDFT::RtypeAdaptor<T, 3, ImpedanceCalc, decltype(R4), decltype(P2),
-                       decltype(S4)>
-        R{std::tie(R4, P2, S4)};
+    using CapacitorStates = std::array<T, 5>;
+
+    /* the circuit itself, one per channel in the scalar build */
+    struct Circuit
+    {
+        Circuit() { setDiodeQuality(WDFT::DiodeQuality::Best); }
+
+        void prepare(T sampleRate)
+        {
+            C1.prepare(sampleRate);
+            C2.prepare(sampleRate);
+            C3.prepare(sampleRate);
+            C4.prepare(sampleRate);
+            C5.prepare(sampleRate);
+
+            Vb.setVoltage((T)4.5f);
+        }
+
+        /* both diode models hang off P3, only the connected one gets impedance
+         * updates, so it's recalculated on connecting */
+        void setDiodeQuality(WDFT::DiodeQuality q)
+        {
+            quality = q;
+            if (q == WDFT::DiodeQuality::Best) {
+                P3.connectToParent(&DPBest);
+                DPBest.calcImpedance();
+            } else {
+                P3.connectToParent(&DPGood);
+                DPGood.calcImpedance();
+            }
+        }
+
+        template <typename Diodes> inline T processSample(T x, Diodes &dp)
+        {
+            Vin.setVoltage(x);
+
+            dp.incident(P3.reflected());
+            P3.incident(dp.reflected());
+
+            return WDFT::voltage<T>(Rout);
+        }
+
+        // propagate signal without returning anything
+        inline void processInit(T x)
+        {
+            if (quality == WDFT::DiodeQuality::Best)
+                processSample(x, DPBest);
+            else
+                processSample(x, DPGood);
+        }
+
+        WDFT::DiodeQuality quality = WDFT::DiodeQuality::Best;
+
+        /* a capacitor's state is its last incident wave, which incident()
+         * also sets */
+        CapacitorStates getCapacitorStates() const
+        {
+            return {C1.wdf.a, C2.wdf.a, C3.wdf.a, C4.wdf.a, C5.wdf.a};
+        }
+
+        void setCapacitorStates(const CapacitorStates &z)
+        {
+            C1.incident(z[0]);
+            C2.incident(z[1]);
+            C3.incident(z[2]);
+            C4.incident(z[3]);
+            C5.incident(z[4]);
+        }
+
+        // Port A
+        WDFT::ResistorT<T> R4{1.0e6f};
+
+        // Port B
+        WDFT::ResistiveVoltageSourceT<T> Vin;
+        WDFT::CapacitorT<T> C1{1.0e-9f};
+        WDFT::WDFParallelT<T, decltype(Vin), decltype(C1)> P1{Vin, C1};
+
+        WDFT::ResistorT<T> R1{10.0e3f};
+        WDFT::CapacitorT<T> C2{10.0e-9f};
+        WDFT::WDFSeriesT<T, decltype(R1), decltype(C2)> S1{R1, C2};
+
+        WDFT::WDFSeriesT<T, decltype(S1), decltype(P1)> S2{S1, P1};
+        WDFT::ResistiveVoltageSourceT<T> Vb{1.0e6f}; // encompasses R2
+        WDFT::WDFParallelT<T, decltype(Vb), decltype(S2)> P2{Vb, S2};
+
+        // Port C
+        // distortion potentiometer
+        WDFT::ResistorT<T> ResDist_R3{rDistVal + R3Val};
+        WDFT::CapacitorT<T> C3{47.0e-9f};
+        WDFT::WDFSeriesT<T, decltype(ResDist_R3), decltype(C3)> S4{
+            ResDist_R3, C3};
+
+        WDFT::RtypeAdaptor<T, 3, ImpedanceCalc, decltype(R4), decltype(P2),
+                           decltype(S4)>
+            R{std::tie(R4, P2, S4)};
+
+        // Port D
+        WDFT::ResistorT<T> R5{10.0e3f};
+        WDFT::CapacitorT<T> C4{1.0e-6f};
+        WDFT::WDFSeriesT<T, decltype(R5), decltype(C4)> S6{R5, C4};
+        WDFT::WDFSeriesT<T, decltype(S6), decltype(R)> S7{S6, R};
+
+        WDFT::ResistorT<T> Rout{10.0e3f};
+        WDFT::WDFParallelT<T, decltype(Rout), decltype(S7)> P4{Rout, S7};
+        WDFT::CapacitorT<T> C5{1.0e-9f};
+        WDFT::WDFParallelT<T, decltype(C5), decltype(P4)> P3{C5, P4};
+
+        WDFT::DiodePairT<T, decltype(P3), WDFT::DiodeQuality::Best> DPBest{
+            P3, 2.52e-9f, 25.85e-3f * 1.75f};
+        WDFT::DiodePairT<T, decltype(P3), WDFT::DiodeQuality::Good> DPGood{
+            P3, 2.52e-9f, 25.85e-3f * 1.75f};
+    };
+
+    /**
+     * What prepare() would otherwise redo for every instance: the scattering
+     * table & the capacitor states the circuit settles to on the bias. No DC
+     * flows through R3, so neither depends on the pot's position at prepare.
+     * Built once per sample rate & shared by every instance in the process.
+     */
+    struct RateData
+    {
+        double sampleRate;
+        ScatteringTable table;
+        CapacitorStates settled;
+    };
+
+    static const RateData &getRateData(Circuit &c, double sampleRate)
+    {
+        static std::mutex mutex;
+        static std::vector<std::unique_ptr<RateData>> cache;
+
+        const std::lock_guard<std::mutex> lock(mutex);
+        for (auto &d : cache)
+            if (d->sampleRate == sampleRate)
+                return *d;
+
+        auto data = std::make_unique<RateData>();
+        data->sampleRate = sampleRate;
+
+        /* solves the adaptor at each table point */
+        for (size_t k = 0; k <= ScatteringTable::size; ++k) {
+            const auto position = ScatteringTable::toPosition(k);
+            c.ResDist_R3.setResistanceValue((T)(position * rDistVal + R3Val));
+            const auto [Ra, Rb, Rc] = c.R.getPortImpedances();
+            auto &entry = data->table.entries[k];
+            entry.Rd = ImpedanceCalc::solve(Ra, Rb, Rc, entry.S);
+        }
 
-    // Port D
-    WDFT::ResistorT<T> R5{10.0e3f};
-    WDFT::CapacitorT<T> C4{1.0e-6f};
-    WDFT::WDFSeriesT<T, decltype(R5), decltype(C4)> S6{R5, C4};
-    WDFT::WDFSeriesT<T, decltype(S6), decltype(R)> S7{S6, R};
+        /* R3 at its minimum gives the shortest time constants, the slowest
+         * left is the bias feeding C2 (1M * 10n), so 100 ms is about ten of
+         * them */
+        c.ResDist_R3.setResistanceValue((T)R3Val);
+        for (size_t i = 0; i < (size_t)(sampleRate * 0.1); ++i)
+            c.processInit(0.5);
+        data->settled = c.getCapacitorStates();
 
-    WDFT::ResistorT<T> Rout{10.0e3f};
-    WDFT::WDFParallelT<T, decltype(Rout), decltype(S7)> P4{Rout, S7};
-    WDFT::CapacitorT<T> C5{1.0e-9f};
-    WDFT::WDFParallelT<T, decltype(C5), decltype(P4)> P3{C5, P4};
+        cache.push_back(std::move(data));
+        return *cache.back();
+    }
 
-    WDFT::DiodePairT<T, decltype(P3), WDFT::DiodeQuality::Best> DP{
-        P3, 2.52e-9f, 25.85e-3f * 1.75f};
+    std::array<Circuit, numCircuits> circuits;
+    const RateData *rateData = nullptr;
+    WDFT::DiodeQuality quality = WDFT::DiodeQuality::Best;
 
     SmoothedValue<double> dist;
 
     strix::SVTFilter<T> dcBlock;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MXRDistWDF)
-};
\ No newline at end of file
+};
@@ -13,7 +13,11 @@ enum EmphasisFilterType
     High
 };
 
-template <typename T, EmphasisFilterType type = Low>
+/**
+ * One emphasis band: its parameters, their smoothing & the shelf pair they
+ * set. The shelves themselves run in EmphasisFilters' cascades.
+ */
+template <EmphasisFilterType type = Low>
 struct EmphasisFilter : AudioProcessorValueTreeState::Listener
 {
     EmphasisFilter(AudioProcessorValueTreeState &_apvts,
@@ -41,126 +45,126 @@ struct EmphasisFilter : AudioProcessorValueTreeState::Listener
     void prepare(const dsp::ProcessSpec &spec)
     {
         SR = spec.sampleRate;
-        float freq_ = *freq;
-        if (freq_ >= SR * 0.5)
-            freq_ = SR * 0.5;
-        lastFreq = freq_;
-        float amount_ = Decibels::decibelsToGain(amount->get());
-        float namount_ = Decibels::decibelsToGain(-amount->get());
-
-        for (size_t i = 0; i < 2; ++i) {
-            fIn[i].prepare(spec);
-            fOut[i].prepare(spec);
-            if (type == Low) {
-                fIn[i].coefficients =
-                    dsp::IIR::Coefficients<double>::makeLowShelf(
-                        SR, freq_, 0.707, amount_);
-                fOut[i].coefficients =
-                    dsp::IIR::Coefficients<double>::makeLowShelf(
-                        SR, freq_, 0.707, namount_);
-            } else {
-                fIn[i].coefficients =
-                    dsp::IIR::Coefficients<double>::makeHighShelf(
-                        SR, freq_, 0.707, amount_);
-                fOut[i].coefficients =
-                    dsp::IIR::Coefficients<double>::makeHighShelf(
-                        SR, freq_, 0.707, namount_);
-            }
-        }
-
         sm_amt.reset(spec.sampleRate, 0.01f);
         sm_freq.reset(spec.sampleRate, 0.01f);
-        sm_amt.setCurrentAndTargetValue(amount_);
-        sm_freq.setCurrentAndTargetValue(freq_);
+        sm_amt.setCurrentAndTargetValue(amount->get());
+        sm_freq.setCurrentAndTargetValue(jmin((double)freq->get(), SR * 0.5));
+        calcCoefficients(sm_freq.getCurrentValue(), sm_amt.getCurrentValue());
+    }
+
+    bool isSmoothing() const
+    {
+        return sm_freq.isSmoothing() || sm_amt.isSmoothing();
     }
 
-    // inOut: 0 = input filter, 1 = output filter
-    // controls whether to update the smoother or just read from it
-    void updateFilters(int inOut)
+    /**
+     * Only the output side advances the smoothers, in steps of numSamples,
+     * so both shelves stay mirror images. The input side picks up the new
+     * coefficients on its next block.
+     */
+    void updateFilters(size_t numSamples)
     {
-        float freq_ =
-            inOut ? sm_freq.getNextValue() : sm_freq.getCurrentValue();
-        if (freq_ > SR * 0.5)
-            freq_ = SR * 0.5;
-        float amt = inOut ? sm_amt.getNextValue() : sm_amt.getCurrentValue();
-        float amount_ = Decibels::decibelsToGain(amt);
-        float namount_ = Decibels::decibelsToGain(-amt);
-
-        for (size_t i = 0; i < 2; ++i) {
-            if (type == Low) {
-                *fIn[i].coefficients =
-                    dsp::IIR::ArrayCoefficients<double>::makeLowShelf(
-                        SR, freq_, 0.707, amount_);
-                *fOut[i].coefficients =
-                    dsp::IIR::ArrayCoefficients<double>::makeLowShelf(
-                        SR, freq_, 0.707, namount_);
-            } else {
-                *fIn[i].coefficients =
-                    dsp::IIR::ArrayCoefficients<double>::makeHighShelf(
-                        SR, freq_, 0.707, amount_);
-                *fOut[i].coefficients =
-                    dsp::IIR::ArrayCoefficients<double>::makeHighShelf(
-                        SR, freq_, 0.707, namount_);
-            }
+        const auto freq_ = sm_freq.skip((int)numSamples);
+        const auto amt = sm_amt.skip((int)numSamples);
+        calcCoefficients(freq_, amt);
+    }
+
+    strix::FloatParameter *amount, *freq;
+    SVFCoefficients cIn, cOut;
+
+  private:
+    void calcCoefficients(float freq_, float amt)
+    {
+        const auto shape = type == Low ? SVFCoefficients::LowShelf
+                                       : SVFCoefficients::HighShelf;
+        SVFCoefficients::makeShelfPair(shape, SR, freq_, 0.707, amt, cIn,
+                                       cOut);
+    }
+
+    AudioProcessorValueTreeState &apvts;
+    SmoothedValue<float> sm_freq, sm_amt;
+    double SR = 44100.0;
+};
+
+/**
+ * The low & high emphasis bands, each boosting before the amp & cutting
+ * after it. Both input shelves run as one cascade, as do both output ones.
+ */
+struct EmphasisFilters
+{
+    EmphasisFilters(AudioProcessorValueTreeState &a)
+        : low(a, (strix::FloatParameter *)a.getParameter("lfEmphasis"),
+              (strix::FloatParameter *)a.getParameter("lfEmphasisFreq")),
+          high(a, (strix::FloatParameter *)a.getParameter("hfEmphasis"),
+               (strix::FloatParameter *)a.getParameter("hfEmphasisFreq"))
+    {
+        for (size_t s = 0; s < 2; ++s) {
+            in.setEnabled(s, true);
+            out.setEnabled(s, true);
         }
     }
 
+    void prepare(const dsp::ProcessSpec &spec)
+    {
+        low.prepare(spec);
+        high.prepare(spec);
+        setSections();
+        reset();
+    }
+
+    void setWorker(Worker *w)
+    {
+        in.setWorker(w);
+        out.setWorker(w);
+    }
+
     void reset()
     {
-        fIn[0].reset();
-        fIn[1].reset();
-        fOut[0].reset();
-        fOut[1].reset();
+        in.reset();
+        out.reset();
     }
 
+    /* the shelves move with the smoothers at this many samples a step */
+    static constexpr size_t updateInterval = 16;
+
     template <typename Block> void processIn(Block &block)
     {
-        if (sm_freq.isSmoothing() || sm_amt.isSmoothing()) {
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                updateFilters(0);
-                for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-                    auto in = block.getChannelPointer(ch);
-                    in[i] = fIn[ch].processSample(in[i]);
-                }
-            }
-            return;
-        }
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-            auto *in = block.getChannelPointer(ch);
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                in[i] = fIn[ch].processSample(in[i]);
-            }
-        }
+        in.process(block);
     }
 
+    /**
+     * In SIMD builds the output shelves can run on an interleaved block, next
+     * to the amp & cab, or on a planar one; both share one filter state.
+     */
     template <typename Block> void processOut(Block &block)
     {
-        if (sm_freq.isSmoothing() || sm_amt.isSmoothing()) {
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                updateFilters(1);
-                for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-                    auto in = block.getChannelPointer(ch);
-                    in[i] = fOut[ch].processSample(in[i]);
-                }
-            }
+        if (!(low.isSmoothing() || high.isSmoothing())) {
+            out.process(block);
             return;
         }
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-            auto *in = block.getChannelPointer(ch);
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                in[i] = fOut[ch].processSample(in[i]);
-            }
+
+        const auto numSamples = block.getNumSamples();
+        for (size_t start = 0; start < numSamples; start += updateInterval) {
+            const auto n = jmin(updateInterval, numSamples - start);
+            if (low.isSmoothing())
+                low.updateFilters(n);
+            if (high.isSmoothing())
+                high.updateFilters(n);
+            setSections();
+            out.process(block, start, n);
         }
-        // lastAmount = *amount;
-        // lastFreq = *freq;
     }
 
-    strix::FloatParameter *amount, *freq;
-
   private:
-    AudioProcessorValueTreeState &apvts;
-    dsp::IIR::Filter<T> fIn[2], fOut[2];
-    SmoothedValue<float> sm_freq, sm_amt;
-    double SR = 44100.0;
-    float lastFreq = 1.f, lastAmount = 1.f;
-};
\ No newline at end of file
+    void setSections()
+    {
+        in.setSection(0, low.cIn);
+        in.setSection(1, high.cIn);
+        out.setSection(0, low.cOut);
+        out.setSection(1, high.cOut);
+    }
+
+    EmphasisFilter<Low> low;
+    EmphasisFilter<High> high;
+    FilterCascade<2> in, out;
+};
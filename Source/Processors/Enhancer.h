@@ -53,6 +53,42 @@ inline void process(strix::AudioBlock<vec> &block, vec gp, vec gn)
         }
     }
 }
+
+/* the same curves, one sample at a time for the fused enhancer kernel */
+inline double processSample(double x, double gp, double gn)
+{
+#if NU_ENHANCE
+    return x >= 0.0 ? (1.0 / gp) * strix::fast_tanh(x * gp)
+                    : (1.0 / gn) * strix::fast_tanh(x * gn);
+#else
+    return x >= 0.0
+               ? (1.0 / gp) * (x * gp) /
+                     std::pow((1.0 + gp * std::pow(std::abs(x * gp), k)),
+                              1.0 / k)
+               : (1.0 / gn) * (x * gn) /
+                     std::pow((1.0 + gn * std::pow(std::abs(x * gn), k)),
+                              1.0 / k);
+#endif
+}
+
+#if USE_SIMD
+inline vec processSample(vec x, double gp, double gn)
+{
+#if NU_ENHANCE
+    return xsimd::select(x >= 0.0, (1.0 / gp) * strix::fast_tanh(x * gp),
+                         (1.0 / gn) * strix::fast_tanh(x * gn));
+#else
+    return xsimd::select(
+        x >= 0.0,
+        (1.0 / gp) * (x * gp) /
+            xsimd::pow((1.0 + gp * xsimd::pow(xsimd::abs(x * gp), k)),
+                       1.0 / k),
+        (1.0 / gn) * (x * gn) /
+            xsimd::pow((1.0 + gn * xsimd::pow(xsimd::abs(x * gn), k)),
+                       1.0 / k));
+#endif
+}
+#endif
 }; // namespace EnhancerSaturation
 
 enum EnhancerType
@@ -61,8 +97,22 @@ enum EnhancerType
     HF
 };
 
-template <typename T, EnhancerType type> struct Enhancer
+/**
+ * A filtered, saturated copy of the signal mixed back onto it. The filter,
+ * drive ramp, saturator, second filter & output ramp all run in one
+ * per-sample kernel which adds straight into the output, with invert folded
+ * into the output ramp. L & R share a vec in SIMD builds.
+ */
+template <EnhancerType type> struct Enhancer
 {
+#if USE_SIMD
+    using Sample = vec;
+    static constexpr size_t numStates = 1;
+#else
+    using Sample = double;
+    static constexpr size_t numStates = 2;
+#endif
+
     Enhancer(AudioProcessorValueTreeState &a) : apvts(a)
     {
         lfAutoGain = apvts.getRawParameterValue("lfEnhanceAuto");
@@ -74,65 +124,37 @@ template <typename T, EnhancerType type> struct Enhancer
     void prepare(const dsp::ProcessSpec &spec)
     {
         SR = spec.sampleRate;
-
-        double lFreq = 0.0;
-        switch (mode) {
-        case Processors::ProcessorType::Guitar:
-            lFreq = 300.0;
-            break;
-        case Processors::ProcessorType::Bass:
-            lFreq = 175.0;
-            break;
-        case Processors::ProcessorType::Channel:
-            lFreq = 200.0;
-            break;
-        }
-
-        double hFreq = 7500.0;
-        if (hFreq >= SR * 0.5)
-            hFreq = SR * 0.5;
-
-        auto lp_c = dsp::FilterDesign<
-            double>::designIIRLowpassHighOrderButterworthMethod(lFreq,
-                                                                spec.sampleRate,
-                                                                1);
-        auto hp_c = dsp::FilterDesign<double>::
-            designIIRHighpassHighOrderButterworthMethod(hFreq, spec.sampleRate,
-                                                        1);
-
-        for (size_t i = 0; i < 2; ++i) {
-            lp1[i].reset(new dsp::IIR::Filter<T>(
-                lp_c[0])); // guaranteed to be one set of coeffs since it's 1st
-                           // order
-            lp2[i].reset(new dsp::IIR::Filter<T>(lp_c[0]));
-            hp1[i].reset(new dsp::IIR::Filter<T>(hp_c[0]));
-            hp2[i].reset(new dsp::IIR::Filter<T>(hp_c[0]));
-        }
-
-        wetBuffer.setSize(spec.numChannels, spec.maximumBlockSize);
+        updateFilters();
+        reset();
     }
 
     /*method for updating filters IN SYNC w/ audio thread*/
     void updateFilters()
     {
-        double freq = 0.0;
-        switch (mode) {
-        case Processors::ProcessorType::Guitar:
-            freq = 300.0;
-            break;
-        case Processors::ProcessorType::Bass:
-            freq = 175.0;
-            break;
-        case Processors::ProcessorType::Channel:
-            freq = 200.0;
-            break;
+        double freq = 7500.0;
+        if (type == EnhancerType::LF) {
+            switch (mode) {
+            case Processors::ProcessorType::Guitar:
+                freq = 300.0;
+                break;
+            case Processors::ProcessorType::Bass:
+                freq = 175.0;
+                break;
+            case Processors::ProcessorType::Channel:
+                freq = 200.0;
+                break;
+            }
         }
 
-        auto lp_c = dsp::FilterDesign<
-            double>::designIIRLowpassHighOrderButterworthMethod(freq, SR, 1);
-        for (size_t i = 0; i < 2; ++i) {
-            lp1[i].reset(new dsp::IIR::Filter<T>(lp_c[0]));
-            lp2[i].reset(new dsp::IIR::Filter<T>(lp_c[0]));
+        /* 1st order Butterworth, as dsp::FilterDesign would make it */
+        const auto n = std::tan(MathConstants<double>::pi *
+                                jmin(freq / SR, 0.49));
+        filter.a1 = (n - 1.0) / (n + 1.0);
+        if (type == EnhancerType::LF) {
+            filter.b0 = filter.b1 = n / (n + 1.0);
+        } else {
+            filter.b0 = 1.0 / (n + 1.0);
+            filter.b1 = -filter.b0;
         }
 
         needUpdate = false;
@@ -140,116 +162,87 @@ template <typename T, EnhancerType type> struct Enhancer
 
     void flagUpdate(bool newFlag) { needUpdate.store(newFlag); }
 
+    void setWorker(Worker *w) { channels.worker = w; }
+
     void reset()
     {
-        for (size_t i = 0; i < 2; ++i) {
-            if (lp1[i])
-                lp1[i]->reset();
-            if (lp2[i])
-                lp2[i]->reset();
-            if (hp1[i])
-                hp1[i]->reset();
-            if (hp2[i])
-                hp2[i]->reset();
-        }
+        for (auto &s : states)
+            s.fill(0.0);
     }
 
-    template <typename Block>
-    void processBlock(Block &block, const double enhance, const bool invert,
-                      const bool mono)
+    /**
+     * Sets the ramps for the coming block.
+     * @return whether the enhancer has anything to add
+     */
+    bool prepareBlock(double enhance, bool invert, size_t numSamples)
     {
+        if (enhance == 0.0)
+            return false;
         if (needUpdate)
             updateFilters();
 
-        const auto numSamples = block.getNumSamples();
-        const auto numChannels = mono ? 1 : block.getNumChannels();
-
-        wetBuffer.copyFrom(0, 0, block.getChannelPointer(0), numSamples);
-        if (!mono)
-            wetBuffer.copyFrom(1, 0, block.getChannelPointer(1), numSamples);
-
-        auto processBlock = Block(wetBuffer).getSubBlock(0, numSamples);
+        double gain, autoGain = 1.0;
+        if (type == EnhancerType::LF) {
+            gain = jmap(enhance, 1.0, 2.0);
+            if ((bool)*lfAutoGain)
+                autoGain = 1.0 / (6.0 * gain);
+        } else {
+            gain = jmap(enhance, 1.0, 4.0);
+            if ((bool)*hfAutoGain)
+                autoGain = 1.0 / (2.0 * gain);
+        }
+        const auto outGain = enhance * autoGain;
+        const auto sign = invert ? -1.0 : 1.0;
+
+        drive.set(lastGain, gain, numSamples);
+        out.set(sign * lastAutoGain, sign * outGain, numSamples);
+        lastGain = gain;
+        lastAutoGain = outGain;
+        return true;
+    }
 
+    /* x plus the enhancer's contribution at sample i of the block */
+    inline Sample processSample(Sample x, size_t state, size_t i)
+    {
+        auto &z = states[state];
+        auto s = filter.process(x, z[0]) * drive.get(i);
         if (type == EnhancerType::LF)
-            processLF(processBlock, enhance);
+            s = EnhancerSaturation::processSample(s, 1.0, 2.0);
         else
-            processHF(processBlock, enhance);
-
-        for (size_t ch = 0; ch < numChannels; ++ch) {
-            auto dest = block.getChannelPointer(ch);
-            auto src = processBlock.getChannelPointer(ch);
-            for (auto i = 0; i < numSamples; ++i) {
-                if (invert)
-                    dest[i] -= src[i];
-                else
-                    dest[i] += src[i];
-            }
-        }
+            s = 2.0 * EnhancerSaturation::processSample(s, 1.0, 1.0);
+        s = filter.process(s, z[1]);
+        return x + out.get(i) * s;
     }
 
+    ChannelRunner channels;
+
   private:
-    template <typename Block> void processHF(Block &block, double enhance)
+    /* transposed direct form II */
+    struct FirstOrder
     {
-        auto gain = jmap(enhance, 1.0, 4.0);
-        double autoGain = 1.0;
-
-        const auto numSamples = block.getNumSamples();
-
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-            auto *in = block.getChannelPointer(ch);
-            for (int i = 0; i < numSamples; ++i)
-                in[i] = hp1[ch]->processSample(in[i]);
-            strix::SmoothGain<T>::applySmoothGain(
-                in, numSamples, gain, lastGain,
-                ch + 1 == block.getNumChannels());
-        }
-
-        EnhancerSaturation::process(block, 1.0, 1.0);
-        block.multiplyBy(2.0);
+        double b0 = 1.0, b1 = 0.0, a1 = 0.0;
 
-        if ((bool)*hfAutoGain)
-            autoGain *= 1.0 / (2.0 * gain);
-
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-            auto *in = block.getChannelPointer(ch);
-            for (size_t i = 0; i < numSamples; ++i)
-                in[i] = hp2[ch]->processSample(in[i]);
-            strix::SmoothGain<T>::applySmoothGain(
-                in, numSamples, enhance * autoGain, lastAutoGain,
-                ch + 1 == block.getNumChannels());
+        inline Sample process(Sample x, Sample &s) const
+        {
+            const Sample y = b0 * x + s;
+            s = b1 * x - a1 * y;
+            return y;
         }
-    }
+    };
 
-    template <typename Block> void processLF(Block &block, double enhance)
+    /* a linear gain ramp across one block */
+    struct Ramp
     {
-        const auto numSamples = block.getNumSamples();
+        double start = 0.0, inc = 0.0;
 
-        auto gain = jmap(enhance, 1.0, 2.0);
-        double autoGain = 1.0;
-
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-            auto in = block.getChannelPointer(ch);
-            for (int i = 0; i < numSamples; ++i)
-                in[i] = lp1[ch]->processSample(in[i]);
-            strix::SmoothGain<T>::applySmoothGain(
-                in, numSamples, gain, lastGain,
-                ch + 1 == block.getNumChannels());
+        void set(double from, double to, size_t numSamples)
+        {
+            start = from;
+            inc = (to - from) / (double)jmax((size_t)1, numSamples);
         }
 
-        EnhancerSaturation::process(block, 1.0, 2.0);
-
-        if ((bool)*lfAutoGain)
-            autoGain *= 1.0 / (6.0 * gain);
-
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-            auto *in = block.getChannelPointer(ch);
-            for (int i = 0; i < numSamples; ++i)
-                in[i] = lp2[ch]->processSample(in[i]);
-            strix::SmoothGain<T>::applySmoothGain(
-                in, numSamples, enhance * autoGain, lastAutoGain,
-                ch + 1 == block.getNumChannels());
-        }
-    }
+        inline double get(size_t i) const { return start + inc * (double)i; }
+    };
 
     double SR = 44100.0;
     std::atomic<bool> needUpdate = false;
@@ -260,15 +253,69 @@ template <typename T, EnhancerType type> struct Enhancer
     std::atomic<float> *hfAutoGain, *lfAutoGain;
 
     double lastGain = 0.0, lastAutoGain = 1.0;
+    Ramp drive, out;
+
+    /* the same coefficients serve both filters, states are per filter */
+    FirstOrder filter;
+    std::array<std::array<Sample, 2>, numStates> states{};
+};
+
+/**
+ * Runs whichever enhancers are on in one pass over block, LF feeding HF as
+ * separate passes would. Call prepareBlock() on each first.
+ */
+struct Enhancers
+{
+    template <bool useLF, bool useHF>
+    static void process(dsp::AudioBlock<double> &block, Enhancer<LF> &lf,
+                        Enhancer<HF> &hf)
+    {
+        const auto numSamples = block.getNumSamples();
+#if USE_SIMD
+        const auto numChannels = jmin(block.getNumChannels(), vec::size);
+        alignas(ScratchArena::alignment) double lanes[vec::size]{};
+        for (size_t i = 0; i < numSamples; ++i) {
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                lanes[ch] = block.getChannelPointer(ch)[i];
+            auto x = xsimd::load_aligned(lanes);
+            if (useLF)
+                x = lf.processSample(x, 0, i);
+            if (useHF)
+                x = hf.processSample(x, 0, i);
+            x.store_aligned(lanes);
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                block.getChannelPointer(ch)[i] = lanes[ch];
+        }
+#else
+        const auto numChannels = jmin(block.getNumChannels(), (size_t)2);
+        lf.channels.process(numChannels, numSamples, [&](size_t ch) {
+            auto *x = block.getChannelPointer(ch);
+            for (size_t i = 0; i < numSamples; ++i) {
+                if (useLF)
+                    x[i] = lf.processSample(x[i], ch, i);
+                if (useHF)
+                    x[i] = hf.processSample(x[i], ch, i);
+            }
+        });
+#endif
+    }
 
-    std::array<std::unique_ptr<dsp::IIR::Filter<T>>, 2> lp1, lp2, hp1, hp2;
-    AudioBuffer<T> wetBuffer;
+    static void process(dsp::AudioBlock<double> &block, Enhancer<LF> &lf,
+                        bool lfOn, Enhancer<HF> &hf, bool hfOn)
+    {
+        if (lfOn && hfOn)
+            process<true, true>(block, lf, hf);
+        else if (lfOn)
+            process<true, false>(block, lf, hf);
+        else if (hfOn)
+            process<false, true>(block, lf, hf);
+    }
 };
 
 // sticking this here bc i don't want to make a new file
 
 /**
- * a wrapper for low- and high-cut filters
+ * a wrapper for low- and high-cut filters, run as one cascade
  */
 struct CutFilters : AudioProcessorValueTreeState::Listener
 {
@@ -276,6 +323,8 @@ struct CutFilters : AudioProcessorValueTreeState::Listener
     {
         apvts.addParameterListener("lfCut", this);
         apvts.addParameterListener("hfCut", this);
+        lfCut = apvts.getRawParameterValue("lfCut");
+        hfCut = apvts.getRawParameterValue("hfCut");
     }
 
     ~CutFilters()
@@ -284,51 +333,77 @@ struct CutFilters : AudioProcessorValueTreeState::Listener
         apvts.removeParameterListener("hfCut", this);
     }
 
-    void parameterChanged(const String &paramID, float newValue) override
+    /* the smoothers & coefficients are only touched on the audio thread */
+    void parameterChanged(const String &, float) override
     {
-        if (paramID == "lfCut")
-            lfCut.setCutoffFreq(newValue);
-        else if (paramID == "hfCut") {
-            if (newValue >= SR * 0.5)
-                newValue = SR * 0.5;
-            hfCut.setCutoffFreq(newValue);
-        }
+        needUpdate = true;
     }
 
     void prepare(const dsp::ProcessSpec &spec)
     {
         SR = spec.sampleRate;
-
-        lfCut.setCutoffFreq(apvts.getRawParameterValue("lfCut")->load());
-        hfCut.setCutoffFreq(apvts.getRawParameterValue("hfCut")->load());
-        lfCut.prepare(spec);
-        hfCut.prepare(spec);
-        lfCut.setType(strix::FilterType::highpass);
-        hfCut.setType(strix::FilterType::lowpass);
-
-        lfCut.setCutoffFreq(apvts.getRawParameterValue("lfCut")->load());
-        auto hfCutFreq = apvts.getRawParameterValue("hfCut")->load();
-        if (hfCutFreq >= SR * 0.5)
-            hfCutFreq = SR * 0.5;
-        hfCut.setCutoffFreq(hfCutFreq);
+        for (auto *sm : {&sm_lf, &sm_hf})
+            sm->reset(SR, 0.05);
+        sm_lf.setCurrentAndTargetValue(lfTarget());
+        sm_hf.setCurrentAndTargetValue(hfTarget());
+        needUpdate = false;
+        setSections();
+        filters.reset();
     }
 
-    void reset()
+    void reset() { filters.reset(); }
+
+    void setWorker(Worker *w) { filters.setWorker(w); }
+
+    /* the cutoffs move with the smoothers at this many samples a step */
+    static constexpr size_t updateInterval = 16;
+
+    template <typename Block> void process(Block &block)
     {
-        lfCut.reset();
-        hfCut.reset();
+        if (needUpdate.exchange(false)) {
+            sm_lf.setTargetValue(lfTarget());
+            sm_hf.setTargetValue(hfTarget());
+        }
+
+        if (!(sm_lf.isSmoothing() || sm_hf.isSmoothing())) {
+            filters.process(block);
+            return;
+        }
+
+        const auto numSamples = block.getNumSamples();
+        for (size_t start = 0; start < numSamples; start += updateInterval) {
+            const auto n = jmin(updateInterval, numSamples - start);
+            sm_lf.skip((int)n);
+            sm_hf.skip((int)n);
+            setSections();
+            filters.process(block, start, n);
+        }
     }
 
-    void process(dsp::AudioBlock<double> &block)
+  private:
+    double lfTarget() const { return (double)lfCut->load(); }
+    double hfTarget() const { return jmin((double)hfCut->load(), SR * 0.5); }
+
+    /**
+     * Section 0 is the low cut, 1 the high cut, each skipped once it has
+     * settled at the end of its range. Both are SVFs, so their cutoffs can
+     * move under a running signal.
+     */
+    void setSections()
     {
-        if (lfCut.getCutoffFreq() > 5.f)
-            lfCut.processBlock(block);
-        if (hfCut.getCutoffFreq() < 22000.f)
-            hfCut.processBlock(block);
+        const auto lf = sm_lf.getCurrentValue();
+        const auto hf = sm_hf.getCurrentValue();
+        filters.setSection(0, SVFCoefficients::makeHighPass(SR, lf));
+        filters.setSection(1, SVFCoefficients::makeLowPass(SR, hf));
+        filters.setEnabled(0, lf > 5.0 || sm_lf.isSmoothing());
+        filters.setEnabled(1, hf < 22000.0 || sm_hf.isSmoothing());
     }
 
-  private:
-    strix::SVTFilter<double, true> lfCut, hfCut;
+    FilterCascade<2> filters;
     AudioProcessorValueTreeState &apvts;
+    std::atomic<float> *lfCut, *hfCut;
+    std::atomic<bool> needUpdate = false;
+    /* cutoffs glide in octaves rather than Hz */
+    SmoothedValue<double, ValueSmoothingTypes::Multiplicative> sm_lf, sm_hf;
     double SR = 44100.0;
-};
\ No newline at end of file
+};
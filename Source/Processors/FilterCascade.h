@@ -0,0 +1,131 @@
+/**
+ * FilterCascade.h
+ * Runs a chain of SVF sections over a block in a single pass
+ */
+
+#pragma once
+
+/**
+ * Separate filters each make their own pass over the buffer. Here every
+ * enabled section runs back to back on a sample while it's still in a
+ * register. In SIMD builds the channels share the lanes of one vec, so stereo
+ * costs what mono does; the scalar build goes channel by channel, split
+ * across the worker like the other linear stages.
+ *
+ * Sections can be changed between calls to process(), their states carry
+ * over.
+ */
+template <size_t maxSections> struct FilterCascade
+{
+    void setSection(size_t index, const SVFCoefficients &c)
+    {
+        sections[index] = c;
+    }
+
+    /* disabled sections are skipped, their states are cleared */
+    void setEnabled(size_t index, bool shouldBeEnabled)
+    {
+        if (enabled[index] == shouldBeEnabled)
+            return;
+        enabled[index] = shouldBeEnabled;
+        if (!shouldBeEnabled)
+            resetSection(index);
+
+        numEnabled = 0;
+        for (size_t s = 0; s < maxSections; ++s)
+            if (enabled[s])
+                order[numEnabled++] = s;
+    }
+
+    bool isActive() const { return numEnabled > 0; }
+
+    void setWorker(Worker *w) { channels.worker = w; }
+
+    void reset()
+    {
+        for (size_t s = 0; s < maxSections; ++s)
+            resetSection(s);
+    }
+
+    template <typename Block> void process(Block &block)
+    {
+        process(block, 0, block.getNumSamples());
+    }
+
+#if USE_SIMD
+    /* interleaved, so all channels are in vec channel 0 */
+    void process(strix::AudioBlock<vec> &block, size_t start,
+                 size_t numSamples)
+    {
+        if (numEnabled == 0)
+            return;
+        jassert(block.getNumChannels() == 1);
+        auto *x = block.getChannelPointer(0);
+        for (size_t i = start; i < start + numSamples; ++i)
+            x[i] = tick(x[i], ic1, ic2);
+    }
+
+    void process(dsp::AudioBlock<double> &block, size_t start,
+                 size_t numSamples)
+    {
+        if (numEnabled == 0)
+            return;
+        const auto numChannels = jmin(block.getNumChannels(), vec::size);
+        alignas(ScratchArena::alignment) double lanes[vec::size]{};
+        for (size_t i = start; i < start + numSamples; ++i) {
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                lanes[ch] = block.getChannelPointer(ch)[i];
+            tick(xsimd::load_aligned(lanes), ic1, ic2).store_aligned(lanes);
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                block.getChannelPointer(ch)[i] = lanes[ch];
+        }
+    }
+#else
+    void process(dsp::AudioBlock<double> &block, size_t start,
+                 size_t numSamples)
+    {
+        if (numEnabled == 0)
+            return;
+        const auto numChannels = jmin(block.getNumChannels(), (size_t)2);
+        channels.process(numChannels, numSamples, [&](size_t ch) {
+            auto *x = block.getChannelPointer(ch);
+            for (size_t i = start; i < start + numSamples; ++i)
+                x[i] = tick(x[i], ic1[ch], ic2[ch]);
+        });
+    }
+#endif
+
+  private:
+    template <typename T, typename State>
+    inline T tick(T x, State &s1, State &s2) const
+    {
+        for (size_t n = 0; n < numEnabled; ++n) {
+            const auto s = order[n];
+            x = sections[s].process(x, s1[s], s2[s]);
+        }
+        return x;
+    }
+
+    void resetSection(size_t s)
+    {
+#if USE_SIMD
+        ic1[s] = ic2[s] = 0.0;
+#else
+        for (size_t ch = 0; ch < 2; ++ch)
+            ic1[ch][s] = ic2[ch][s] = 0.0;
+#endif
+    }
+
+    std::array<SVFCoefficients, maxSections> sections;
+    std::array<bool, maxSections> enabled{};
+    std::array<size_t, maxSections> order{};
+    size_t numEnabled = 0;
+
+#if USE_SIMD
+    std::array<vec, maxSections> ic1{}, ic2{};
+#else
+    std::array<std::array<double, maxSections>, 2> ic1{}, ic2{};
+#endif
+
+    ChannelRunner channels;
+};
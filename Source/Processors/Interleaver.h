@@ -0,0 +1,79 @@
+/**
+ * Interleaver.h
+ * Packs double channels into vec lanes for the SIMD processors
+ */
+
+#pragma once
+
+#if USE_SIMD
+/**
+ * Channel ch lands in lane ch % vec::size of vec channel ch / vec::size, and
+ * unused lanes are zeroed. The interleaved block is allocated from a
+ * ScratchArena, so it's valid until the caller's Scope ends.
+ */
+struct Interleaver
+{
+    static constexpr size_t numVecChannels(size_t numChannels)
+    {
+        return (numChannels + vec::size - 1) / vec::size;
+    }
+
+    strix::AudioBlock<vec> interleaveBlock(ScratchArena &arena,
+                                           const dsp::AudioBlock<double> &block)
+    {
+        source = block;
+        const auto numChannels = block.getNumChannels();
+        const auto numSamples = block.getNumSamples();
+        const auto numVec = numVecChannels(numChannels);
+        auto **data = arena.allocateChannels<vec>(numVec, numSamples);
+
+        alignas(ScratchArena::alignment) double lanes[vec::size]{};
+        for (size_t v = 0; v < numVec; ++v) {
+            const double *in[vec::size]{};
+            for (size_t l = 0; l < vec::size; ++l)
+                if (v * vec::size + l < numChannels)
+                    in[l] = block.getChannelPointer(v * vec::size + l);
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                for (size_t l = 0; l < vec::size; ++l)
+                    lanes[l] = in[l] != nullptr ? in[l][i] : 0.0;
+                data[v][i] = xsimd::load_aligned(lanes);
+            }
+        }
+
+        return strix::AudioBlock<vec>(data, numVec, numSamples);
+    }
+
+    /* writes back into the block passed to the last interleaveBlock() */
+    void deinterleaveBlock(strix::AudioBlock<vec> &simdBlock)
+    {
+        deinterleaveBlock(simdBlock, source);
+    }
+
+    void deinterleaveBlock(strix::AudioBlock<vec> &simdBlock,
+                           dsp::AudioBlock<double> &dest)
+    {
+        const auto numChannels = dest.getNumChannels();
+        const auto numSamples = dest.getNumSamples();
+
+        alignas(ScratchArena::alignment) double lanes[vec::size];
+        for (size_t v = 0; v < simdBlock.getNumChannels(); ++v) {
+            double *out[vec::size]{};
+            for (size_t l = 0; l < vec::size; ++l)
+                if (v * vec::size + l < numChannels)
+                    out[l] = dest.getChannelPointer(v * vec::size + l);
+
+            const auto *in = simdBlock.getChannelPointer(v);
+            for (size_t i = 0; i < numSamples; ++i) {
+                in[i].store_aligned(lanes);
+                for (size_t l = 0; l < vec::size; ++l)
+                    if (out[l] != nullptr)
+                        out[l][i] = lanes[l];
+            }
+        }
+    }
+
+  private:
+    dsp::AudioBlock<double> source;
+};
+#endif
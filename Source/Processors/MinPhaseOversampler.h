@@ -0,0 +1,244 @@
+/**
+ * MinPhaseOversampler.h
+ * 4x oversampling with minimum-phase IIR anti-imaging filters
+ */
+
+#pragma once
+
+/**
+ * Two 2x stages, each an elliptic lowpass cascade (minimum phase, so nothing
+ * is delayed beyond the filters' own group delay). Up & down together delay
+ * low frequencies by about 6 base-rate samples, a fraction of the linear-phase
+ * FIR oversampler's, though not sub-sample: a cascade steep enough to reject
+ * the images can't get there. Every channel runs in its own lane of a vec, so
+ * a stereo block costs the same as a mono one. Mirrors the parts of
+ * dsp::Oversampling's interface the processor uses.
+ */
+class MinPhaseOversampler
+{
+  public:
+    static constexpr size_t numStages = 2;
+
+    MinPhaseOversampler(size_t numChannels)
+        : numVec((numChannels + vec::size - 1) / vec::size),
+          numChannels(numChannels)
+    {
+        /* designed at normalised rates, so a sample rate change keeps them.
+         * Stage 0 passes 0.4 fs and stops at 0.6 fs, stage 1 only has to
+         * reject stage 0's images from 1.4 fs */
+        for (auto *stages : {&up, &down}) {
+            (*stages)[0].design(0.5, 2.0, 0.1);
+            (*stages)[1].design(0.9, 4.0, 0.25);
+        }
+    }
+
+    size_t getOversamplingFactor() const { return (size_t)1 << numStages; }
+
+    /* base-rate group delay at low frequencies, up & down */
+    double getLatencyInSamples() const
+    {
+        double latency = 0.0;
+        for (size_t s = 0; s < numStages; ++s)
+            latency += 2.0 * up[s].groupDelay / (double)((size_t)2 << s);
+        return latency;
+    }
+
+    void initProcessing(size_t maxSamplesPerBlock)
+    {
+        osBuffer.setSize((int)numChannels,
+                         (int)(maxSamplesPerBlock * getOversamplingFactor()),
+                         false, false, true);
+        for (size_t s = 0; s < numStages; ++s) {
+            up[s].allocate(numVec);
+            down[s].allocate(numVec);
+        }
+        reset();
+    }
+
+    void reset()
+    {
+        for (size_t s = 0; s < numStages; ++s) {
+            up[s].reset();
+            down[s].reset();
+        }
+    }
+
+    dsp::AudioBlock<double>
+    processSamplesUp(const dsp::AudioBlock<double> &block)
+    {
+        const auto numSamples = block.getNumSamples();
+        const auto nCh = jmin(block.getNumChannels(), numChannels);
+        jassert(numSamples * getOversamplingFactor() <=
+                (size_t)osBuffer.getNumSamples());
+
+        alignas(64) double lanes[vec::size]{};
+        for (size_t v = 0; v < numVec; ++v) {
+            const double *in[vec::size]{};
+            double *out[vec::size]{};
+            for (size_t l = 0; l < vec::size; ++l) {
+                if (v * vec::size + l < nCh) {
+                    in[l] = block.getChannelPointer(v * vec::size + l);
+                    out[l] = osBuffer.getWritePointer(
+                        (int)(v * vec::size + l));
+                }
+            }
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                for (size_t l = 0; l < vec::size; ++l)
+                    lanes[l] = in[l] != nullptr ? in[l][i] : 0.0;
+                /* zero-stuffing halves the level, so each stage gains 2 */
+                const auto x = xsimd::load_aligned(lanes) * 2.0;
+
+                vec y[4];
+                const auto h0 = up[0].process(v, x);
+                const auto h1 = up[0].process(v, vec(0.0));
+                y[0] = up[1].process(v, h0 * 2.0);
+                y[1] = up[1].process(v, vec(0.0));
+                y[2] = up[1].process(v, h1 * 2.0);
+                y[3] = up[1].process(v, vec(0.0));
+
+                for (size_t k = 0; k < 4; ++k) {
+                    y[k].store_aligned(lanes);
+                    for (size_t l = 0; l < vec::size; ++l)
+                        if (out[l] != nullptr)
+                            out[l][i * 4 + k] = lanes[l];
+                }
+            }
+        }
+
+        return dsp::AudioBlock<double>(osBuffer).getSubBlock(
+            0, numSamples * getOversamplingFactor());
+    }
+
+    /* reads the internal buffer processSamplesUp() returned */
+    void processSamplesDown(dsp::AudioBlock<double> &block)
+    {
+        const auto numSamples = block.getNumSamples();
+        const auto nCh = jmin(block.getNumChannels(), numChannels);
+
+        alignas(64) double lanes[vec::size]{};
+        for (size_t v = 0; v < numVec; ++v) {
+            const double *in[vec::size]{};
+            double *out[vec::size]{};
+            for (size_t l = 0; l < vec::size; ++l) {
+                if (v * vec::size + l < nCh) {
+                    in[l] = osBuffer.getReadPointer((int)(v * vec::size + l));
+                    out[l] = block.getChannelPointer(v * vec::size + l);
+                }
+            }
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                vec x[4];
+                for (size_t k = 0; k < 4; ++k) {
+                    for (size_t l = 0; l < vec::size; ++l)
+                        lanes[l] = in[l] != nullptr ? in[l][i * 4 + k] : 0.0;
+                    x[k] = xsimd::load_aligned(lanes);
+                }
+
+                /* every input has to pass the filters, every other output is
+                 * kept */
+                const auto h0 = down[1].process(v, x[0]);
+                down[1].process(v, x[1]);
+                const auto h1 = down[1].process(v, x[2]);
+                down[1].process(v, x[3]);
+                const auto y = down[0].process(v, h0);
+                down[0].process(v, h1);
+
+                y.store_aligned(lanes);
+                for (size_t l = 0; l < vec::size; ++l)
+                    if (out[l] != nullptr)
+                        out[l][i] = lanes[l];
+            }
+        }
+    }
+
+  private:
+    /* second-order sections, first-order ones have b2 = a2 = 0 */
+    struct Section
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    /* one 2x stage: an elliptic cascade & its state per vec */
+    struct Stage
+    {
+        /**
+         * @param frequency centre of the transition band
+         * @param sampleRate the stage's output rate, relative to the base
+         * rate
+         * @param transitionWidth relative to sampleRate
+         */
+        void design(double frequency, double sampleRate,
+                    double transitionWidth)
+        {
+            auto coeffs = dsp::FilterDesign<double>::
+                designIIRLowpassHighOrderEllipticMethod(
+                    frequency, sampleRate, transitionWidth, -0.05, -90.0);
+
+            sections.clear();
+            groupDelay = 0.0;
+            /* well below the passband edge, where the delay is flat */
+            const auto f = 0.01 * sampleRate;
+            const auto df = 1.0e-4 * sampleRate;
+
+            for (auto *c : coeffs) {
+                const auto *raw = c->getRawCoefficients();
+                Section s;
+                if (c->getFilterOrder() == 1) {
+                    s.b0 = raw[0];
+                    s.b1 = raw[1];
+                    s.a1 = raw[2];
+                } else {
+                    s.b0 = raw[0];
+                    s.b1 = raw[1];
+                    s.b2 = raw[2];
+                    s.a1 = raw[3];
+                    s.a2 = raw[4];
+                }
+                sections.push_back(s);
+
+                auto dphi = c->getPhaseForFrequency(f + df, sampleRate) -
+                            c->getPhaseForFrequency(f - df, sampleRate);
+                dphi = std::remainder(dphi, MathConstants<double>::twoPi);
+                groupDelay -= dphi * sampleRate /
+                              (MathConstants<double>::twoPi * 2.0 * df);
+            }
+        }
+
+        void allocate(size_t numVec)
+        {
+            stride = sections.size();
+            state.resize(numVec * stride);
+        }
+
+        void reset() { std::fill(state.begin(), state.end(), State{}); }
+
+        /* transposed direct form II, one state pair per section & vec */
+        vec process(size_t v, vec x)
+        {
+            auto *st = state.data() + v * stride;
+            for (size_t n = 0; n < stride; ++n) {
+                const auto &c = sections[n];
+                const auto y = c.b0 * x + st[n].s1;
+                st[n].s1 = c.b1 * x - c.a1 * y + st[n].s2;
+                st[n].s2 = c.b2 * x - c.a2 * y;
+                x = y;
+            }
+            return x;
+        }
+
+        struct State
+        {
+            vec s1 = 0.0, s2 = 0.0;
+        };
+
+        std::vector<Section> sections;
+        std::vector<State> state;
+        size_t stride = 0;
+        double groupDelay = 0.0; // in samples at the stage's output rate
+    };
+
+    std::array<Stage, numStages> up, down;
+    AudioBuffer<double> osBuffer;
+    const size_t numVec, numChannels;
+};
@@ -4,6 +4,11 @@
 
 #pragma once
 
+/**
+ * Both pre-filters run their sections from one BiquadBank, inline in a
+ * single pass. The dynamic HP is mixed in at a gain set from the input gain
+ * once per block.
+ */
 template <typename T> struct GuitarPreFilter : PreampProcessor
 {
     GuitarPreFilter() = default;
@@ -13,120 +18,62 @@ template <typename T> struct GuitarPreFilter : PreampProcessor
         SR = spec.sampleRate;
 
         changeFilters();
-
-        for (auto &b : bandPass)
-            b.prepare(spec);
-        for (auto &h : hiShelf)
-            h.prepare(spec);
-        for (auto &l : sc_lp)
-            l.prepare(spec);
-
-        dynHP.prepare(spec);
-        dynHP.setType(strix::FilterType::firstOrderHighpass);
+        reset();
     }
 
     void changeFilters()
     {
+        using Coeffs = dsp::IIR::ArrayCoefficients<double>;
+        double dynHPFreq = 350.0;
         switch (type) {
         case GammaRay:
-            bp_coeffs = dsp::IIR::Coefficients<double>::makeHighPass(SR, 350.f);
-            hs_coeffs = dsp::IIR::Coefficients<double>::makeHighShelf(
-                SR, 350.f, 0.7f, 4.f);
-            lp_coeffs = dsp::IIR::Coefficients<double>::makeLowPass(
-                SR, 6200.f > SR * 0.5 ? SR * 0.5 : 6200.f);
-            dynHP.setCutoffFreq(350.0);
+            bank.set(bandPass,
+                     BiquadCoeffs::from(Coeffs::makeHighPass(SR, 350.0)));
+            bank.set(hiShelf, BiquadCoeffs::from(Coeffs::makeHighShelf(
+                                  SR, 350.0, 0.7, 4.0)));
+            bank.set(lowPass, BiquadCoeffs::from(Coeffs::makeLowPass(
+                                  SR, jmin(6200.0, SR * 0.5))));
+            dynHPFreq = 350.0;
             break;
         case Sunbeam:
-            bp_coeffs = dsp::IIR::Coefficients<double>::makeHighPass(
-                SR, 350.f); /*unused*/
-            hs_coeffs = dsp::IIR::Coefficients<double>::makeHighShelf(
-                SR, 750.f, 0.7f, 2.f);
-            lp_coeffs = dsp::IIR::Coefficients<double>::makeFirstOrderLowPass(
-                SR, 7200.f > SR * 0.5 ? SR * 0.5 : 7200.f);
-            dynHP.setCutoffFreq(1200.0);
+            bank.set(bandPass, /*unused*/
+                     BiquadCoeffs::from(Coeffs::makeHighPass(SR, 350.0)));
+            bank.set(hiShelf, BiquadCoeffs::from(Coeffs::makeHighShelf(
+                                  SR, 750.0, 0.7, 2.0)));
+            bank.set(lowPass, BiquadCoeffs::from(Coeffs::makeFirstOrderLowPass(
+                                  SR, jmin(7200.0, SR * 0.5))));
+            dynHPFreq = 1200.0;
             break;
         case Moonbeam:
-            bp_coeffs = dsp::IIR::Coefficients<double>::makeFirstOrderHighPass(
-                SR, 150.f);
-            hs_coeffs = dsp::IIR::Coefficients<double>::makeHighShelf(
-                SR, 175.f, 0.666f, 4.f);
-            lp_coeffs = dsp::IIR::Coefficients<double>::makeLowPass(
-                SR, 7500.f > SR * 0.5 ? SR * 0.5 : 7500.f);
-            dynHP.setCutoffFreq(350.0);
+            bank.set(bandPass, BiquadCoeffs::from(
+                                   Coeffs::makeFirstOrderHighPass(SR, 150.0)));
+            bank.set(hiShelf, BiquadCoeffs::from(Coeffs::makeHighShelf(
+                                  SR, 175.0, 0.666, 4.0)));
+            bank.set(lowPass, BiquadCoeffs::from(Coeffs::makeLowPass(
+                                  SR, jmin(7500.0, SR * 0.5))));
+            dynHPFreq = 350.0;
             break;
         case XRay:
-            bp_coeffs = dsp::IIR::Coefficients<double>::makeHighPass(SR, 450.f);
-            hs_coeffs = dsp::IIR::Coefficients<double>::makeHighShelf(
-                SR, 350.f, 0.7f, 3.f);
-            lp_coeffs = dsp::IIR::Coefficients<double>::makeLowPass(SR, 5500.f);
-            dynHP.setCutoffFreq(500.0);
+            bank.set(bandPass,
+                     BiquadCoeffs::from(Coeffs::makeHighPass(SR, 450.0)));
+            bank.set(hiShelf, BiquadCoeffs::from(Coeffs::makeHighShelf(
+                                  SR, 350.0, 0.7, 3.0)));
+            bank.set(lowPass, BiquadCoeffs::from(Coeffs::makeLowPass(
+                                  SR, jmin(5500.0, SR * 0.5))));
+            dynHPFreq = 500.0;
             break;
         }
 
-        for (auto &b : bandPass)
-            b.coefficients = bp_coeffs;
-        for (auto &h : hiShelf)
-            h.coefficients = hs_coeffs;
-        for (auto &l : sc_lp)
-            l.coefficients = lp_coeffs;
+        bank.set(dynHP, BiquadCoeffs::from(
+                            Coeffs::makeFirstOrderHighPass(SR, dynHPFreq)));
     }
 
-    void reset()
-    {
-        for (auto &b : bandPass)
-            b.reset();
-        for (auto &b : hiShelf)
-            b.reset();
-        for (auto &b : sc_lp)
-            b.reset();
-    }
+    void reset() { bank.reset(); }
 
 #if USE_SIMD
-    void process(strix::AudioBlock<vec> &block)
-    {
-        auto dynHPGain = 1.f / jmax(inGain, 1.f);
-        if (*hiGain) {
-            for (int ch = 0; ch < block.getNumChannels(); ++ch) {
-                auto in = block.getChannelPointer(ch);
-                for (int i = 0; i < block.getNumSamples(); ++i) {
-                    in[i] = hiShelf[ch].processSample(in[i]);
-                    in[i] = sc_lp[ch].processSample(in[i]);
-                    in[i] += dynHPGain * dynHP.processSample(ch, in[i]);
-                }
-            }
-        } else {
-            for (int ch = 0; ch < block.getNumChannels(); ++ch) {
-                auto in = block.getChannelPointer(ch);
-                for (int i = 0; i < block.getNumSamples(); ++i) {
-                    in[i] = bandPass[ch].processSample(in[i]);
-                    in[i] += dynHPGain * dynHP.processSample(ch, in[i]);
-                }
-            }
-        }
-    }
+    void process(strix::AudioBlock<vec> &block) { processFilters(block); }
 #else
-    void process(dsp::AudioBlock<double> &block)
-    {
-        auto dynHPGain = 1.f / jmax(inGain, 1.f);
-        if (*hiGain) {
-            for (int ch = 0; ch < block.getNumChannels(); ++ch) {
-                auto in = block.getChannelPointer(ch);
-                for (int i = 0; i < block.getNumSamples(); ++i) {
-                    in[i] = hiShelf[ch].processSample(in[i]);
-                    in[i] = sc_lp[ch].processSample(in[i]);
-                    in[i] += dynHPGain * dynHP.processSample(ch, in[i]);
-                }
-            }
-        } else {
-            for (int ch = 0; ch < block.getNumChannels(); ++ch) {
-                auto in = block.getChannelPointer(ch);
-                for (int i = 0; i < block.getNumSamples(); ++i) {
-                    in[i] = bandPass[ch].processSample(in[i]);
-                    in[i] += dynHPGain * dynHP.processSample(ch, in[i]);
-                }
-            }
-        }
-    }
+    void process(dsp::AudioBlock<double> &block) { processFilters(block); }
 #endif
 
     strix::BoolParameter *hiGain = nullptr;
@@ -135,9 +82,34 @@ template <typename T> struct GuitarPreFilter : PreampProcessor
     float inGain = 1.f;
 
   private:
-    std::array<dsp::IIR::Filter<T>, 2> bandPass, hiShelf, sc_lp;
-    dsp::IIR::Coefficients<double>::Ptr bp_coeffs, hs_coeffs, lp_coeffs;
-    strix::SVTFilter<T> dynHP;
+    enum Section
+    {
+        bandPass,
+        hiShelf,
+        lowPass,
+        dynHP,
+        numSections
+    };
+
+    template <typename Block> void processFilters(Block &block)
+    {
+        const auto dynHPGain = 1.0 / jmax((double)inGain, 1.0);
+        const bool hi = *hiGain;
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+            auto *in = block.getChannelPointer(ch);
+            for (size_t i = 0; i < block.getNumSamples(); ++i) {
+                T x;
+                if (hi)
+                    x = bank.process(lowPass, ch,
+                                     bank.process(hiShelf, ch, in[i]));
+                else
+                    x = bank.process(bandPass, ch, in[i]);
+                in[i] = x + dynHPGain * bank.process(dynHP, ch, x);
+            }
+        }
+    }
+
+    BiquadBank<T, numSections> bank;
 
     double SR = 44100.0;
 };
@@ -149,69 +121,46 @@ template <typename T> struct BassPreFilter : PreampProcessor
     void prepare(const dsp::ProcessSpec &spec)
     {
         SR = spec.sampleRate;
-        filter.resize(spec.numChannels);
-        for (auto &f : filter)
-            f.prepare(spec);
-        dynHP.prepare(spec);
-        dynHP.setType(strix::FilterType::firstOrderHighpass);
         changeFilters();
+        reset();
     }
 
-    void reset()
-    {
-        for (auto &f : filter)
-            f.reset();
-    }
+    void reset() { bank.reset(); }
 
     void changeFilters()
     {
+        using Coeffs = dsp::IIR::ArrayCoefficients<double>;
+        double dynHPFreq = 600.0;
         switch (type) {
         case Cobalt:
-            for (auto &f : filter)
-                *f.coefficients =
-                    dsp::IIR::ArrayCoefficients<double>::makePeakFilter(
-                        SR, 950.0, 0.7, 0.3);
-            dynHP.setCutoffFreq(600.0);
+            bank.set(peak, BiquadCoeffs::from(
+                               Coeffs::makePeakFilter(SR, 950.0, 0.7, 0.3)));
+            dynHPFreq = 600.0;
             break;
         case Emerald:
-            for (auto &f : filter)
-                *f.coefficients =
-                    dsp::IIR::ArrayCoefficients<double>::makePeakFilter(
-                        SR, 1000.0, 0.7, 0.5);
-            dynHP.setCutoffFreq(900.0);
+            bank.set(peak, BiquadCoeffs::from(
+                               Coeffs::makePeakFilter(SR, 1000.0, 0.7, 0.5)));
+            dynHPFreq = 900.0;
             break;
         case Quartz:
-            for (auto &f : filter)
-                *f.coefficients =
-                    dsp::IIR::ArrayCoefficients<double>::makePeakFilter(
-                        SR, 1500.0, 0.5, 1.2);
-            dynHP.setCutoffFreq(1200.0);
+            bank.set(peak, BiquadCoeffs::from(
+                               Coeffs::makePeakFilter(SR, 1500.0, 0.5, 1.2)));
+            dynHPFreq = 1200.0;
             break;
         }
+
+        bank.set(dynHP, BiquadCoeffs::from(
+                            Coeffs::makeFirstOrderHighPass(SR, dynHPFreq)));
     }
 #if USE_SIMD
     void process(strix::AudioBlock<vec> &block) override
     {
-        float dynHPGain = 1.f / jmax(inGain, 1.f);
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-            auto in = block.getChannelPointer(ch);
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                in[i] = filter[ch].processSample(in[i]);
-                in[i] += dynHPGain * dynHP.processSample(ch, in[i]);
-            }
-        }
+        processFilters(block);
     }
 #else
     void process(dsp::AudioBlock<double> &block) override
     {
-        float dynHPGain = 1.f / jmax(inGain, 1.f);
-        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-            auto in = block.getChannelPointer(ch);
-            for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                in[i] = filter[ch].processSample(in[i]);
-                in[i] += dynHPGain * dynHP.processSample(ch, in[i]);
-            }
-        }
+        processFilters(block);
     }
 #endif
     strix::BoolParameter *hiGain = nullptr;
@@ -219,8 +168,26 @@ template <typename T> struct BassPreFilter : PreampProcessor
     BassMode type;
 
   private:
-    std::vector<dsp::IIR::Filter<T>> filter;
-    strix::SVTFilter<T> dynHP;
+    enum Section
+    {
+        peak,
+        dynHP,
+        numSections
+    };
+
+    template <typename Block> void processFilters(Block &block)
+    {
+        const auto dynHPGain = 1.0 / jmax((double)inGain, 1.0);
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+            auto *in = block.getChannelPointer(ch);
+            for (size_t i = 0; i < block.getNumSamples(); ++i) {
+                const auto x = bank.process(peak, ch, in[i]);
+                in[i] = x + dynHPGain * bank.process(dynHP, ch, x);
+            }
+        }
+    }
+
+    BiquadBank<T, numSections> bank;
 
     double SR = 44100.0;
 };
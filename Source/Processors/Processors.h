@@ -47,11 +47,20 @@ struct PreampProcessor
     bool shouldBypass = false;
 };
 
+#include "ScratchArena.h" // used by the stages below
+#include "Interleaver.h"
+#include "Worker.h"
+#include "SVF.h"
+#include "FilterCascade.h"
+#include "BiquadBank.h"
+
 #include "Cab.h"
+#include "Crossfader.h"
 #include "Comp.h"
 #include "DistPlus.h"
 #include "EmphasisFilters.h"
 #include "Enhancer.h"
+#include "MinPhaseOversampler.h"
 #include "PreFilters.h"
 #include "Reverb/Reverb.hpp"
 #include "ToneStack.h"
@@ -145,6 +154,8 @@ struct Processor : AudioProcessorValueTreeState::Listener
 
     virtual void setDistParam(float newValue) { mxr.setParams(1.f - newValue); }
 
+    void setDiodeQuality(WDFT::DiodeQuality q) { mxr.setDiodeQuality(q); }
+
     /*0 = bass | 1 = mid | 2 = treble*/
     virtual void setToneControl(int control, float newValue)
     {
@@ -169,6 +180,27 @@ struct Processor : AudioProcessorValueTreeState::Listener
         return comp.getGRSource();
     }
 
+    void setArena(ScratchArena *a)
+    {
+        arena = a;
+        mxr.setArena(a);
+    }
+
+    /* peak arena use of processBlock: MXR's dry copy & Channel's tube
+     * crossfade copy */
+    static size_t scratchBytes(const dsp::ProcessSpec &spec)
+    {
+#if USE_SIMD
+        return 2 * ScratchArena::bytesForBlock<vec>(
+                       Interleaver::numVecChannels(spec.numChannels),
+                       spec.maximumBlockSize);
+#else
+        return 2 * ScratchArena::bytesForBlock<double>(spec.numChannels,
+                                                       spec.maximumBlockSize);
+#endif
+    }
+
+    /* sits outside the amp, so it's prepared & run at the base rate */
     OptoComp<double> comp;
 
   protected:
@@ -178,8 +210,6 @@ struct Processor : AudioProcessorValueTreeState::Listener
         numSamples = spec.maximumBlockSize;
         numChannels = spec.numChannels;
 
-        comp.prepare(spec);
-
         mxr.prepare(spec);
 
         for (auto &t : triode)
@@ -189,8 +219,6 @@ struct Processor : AudioProcessorValueTreeState::Listener
             toneStack->prepare(spec);
 
         pentode.prepare(spec);
-
-        simd.setInterleavedBlockSize(spec.numChannels, spec.maximumBlockSize);
     }
 
     AudioProcessorValueTreeState &apvts;
@@ -215,7 +243,7 @@ struct Processor : AudioProcessorValueTreeState::Listener
     strix::BoolParameter *ampAutoGain, *hiGain, *linked;
     double lastInGain, lastOutGain;
 
-    strix::SIMD<double, dsp::AudioBlock<double>, strix::AudioBlock<vec>> simd;
+    ScratchArena *arena = nullptr;
 
     double SR = 44100.0;
     int numSamples = 0, numChannels = 0;
@@ -407,24 +435,23 @@ template <typename T> struct Guitar : Processor
         }
     }
 
-    template <typename FloatType>
-    void processBlock(dsp::AudioBlock<FloatType> &block)
+    /* SIMD builds take the block already interleaved by the caller */
+#if USE_SIMD
+    void processBlock(strix::AudioBlock<vec> &processBlock)
+#else
+    void processBlock(dsp::AudioBlock<double> &processBlock)
+#endif
     {
-        FloatType gain_raw = jmap(inGain->get(), 1.f, 12.f);
-        FloatType out_raw = jmap(outGain->get(), 1.f, 12.f);
+        ScratchArena::Scope scope(*arena);
+        double gain_raw = jmap(inGain->get(), 1.f, 12.f);
+        double out_raw = jmap(outGain->get(), 1.f, 12.f);
 
         gtrPre.inGain = gain_raw;
         pentode.inGain = *outGain;
 
-        FloatType autoGain = 1.0;
+        double autoGain = 1.0;
         bool ampAutoGain_ = *ampAutoGain;
 
-#if USE_SIMD
-        auto simdBlock = simd.interleaveBlock(block);
-        auto &&processBlock = simdBlock;
-#else
-        auto &&processBlock = block;
-#endif
         if (*dist > 0.f)
             mxr.processBlock(processBlock);
         else
@@ -461,9 +488,6 @@ template <typename T> struct Guitar : Processor
 
         // processBlock.multiplyBy(autoGain);
 
-#if USE_SIMD
-        simd.deinterleaveBlock(processBlock);
-#endif
     }
 
     GuitarMode currentType = GammaRay;
@@ -628,24 +652,23 @@ template <typename T> struct Bass : Processor
         }
     }
 
-    template <typename FloatType>
-    void processBlock(dsp::AudioBlock<FloatType> &block)
+    /* SIMD builds take the block already interleaved by the caller */
+#if USE_SIMD
+    void processBlock(strix::AudioBlock<vec> &processBlock)
+#else
+    void processBlock(dsp::AudioBlock<double> &processBlock)
+#endif
     {
-        FloatType gain_raw = jmap(inGain->get(), 1.f, 8.f);
-        FloatType out_raw = jmap(outGain->get(), 1.f, 8.f);
+        ScratchArena::Scope scope(*arena);
+        double gain_raw = jmap(inGain->get(), 1.f, 8.f);
+        double out_raw = jmap(outGain->get(), 1.f, 8.f);
 
         preFilter.inGain = gain_raw;
         pentode.inGain = *outGain;
 
-        FloatType autoGain = 1.0;
+        double autoGain = 1.0;
         bool ampAutoGain_ = *ampAutoGain;
 
-#if USE_SIMD
-        auto simdBlock = simd.interleaveBlock(block);
-        auto &&processBlock = simdBlock;
-#else
-        auto &&processBlock = block;
-#endif
         if (*dist > 0.f)
             mxr.processBlock(processBlock);
         else
@@ -686,9 +709,6 @@ template <typename T> struct Bass : Processor
 
         // processBlock.multiplyBy(autoGain);
 
-#if USE_SIMD
-        simd.deinterleaveBlock(processBlock);
-#endif
     }
 
   private:
@@ -748,11 +768,6 @@ template <typename T> struct Channel : Processor
         sm_mid.setCurrentAndTargetValue(midGain);
         sm_hi.reset(SR, 0.01f);
         sm_hi.setCurrentAndTargetValue(trebGain);
-
-        // tmp = (T**)malloc(sizeof(T*) * spec.numChannels);
-        // for (size_t ch = 0; ch < spec.numChannels; ++ch)
-        //     tmp[ch] = (T*)malloc(sizeof(T) * spec.maximumBlockSize);
-        tmp.setSize(spec.numChannels, spec.maximumBlockSize);
     }
 
     inline void setBias(size_t id, float newFirst, float newSecond)
@@ -816,8 +831,6 @@ template <typename T> struct Channel : Processor
         this->midGain = midGain;
         this->trebGain = trebleGain;
         updateFilters = true;
-
-        tmp.setSize(spec.numChannels, spec.maximumBlockSize);
     }
 
     void setFilters(int index, float newValue = 0.5f)
@@ -867,13 +880,18 @@ template <typename T> struct Channel : Processor
         }
     }
 
-    template <typename FloatType>
-    void processBlock(dsp::AudioBlock<FloatType> &block)
+    /* SIMD builds take the block already interleaved by the caller */
+#if USE_SIMD
+    void processBlock(strix::AudioBlock<vec> &processBlock)
+#else
+    void processBlock(dsp::AudioBlock<double> &processBlock)
+#endif
     {
+        ScratchArena::Scope scope(*arena);
         auto inGain_ = inGain->get();
         auto outGain_ = outGain->get();
-        FloatType gain_raw = jmap(inGain_, 1.f, 4.f);
-        FloatType out_raw = jmap(outGain_, 1.f, 4.f);
+        double gain_raw = jmap(inGain_, 1.f, 4.f);
+        double out_raw = jmap(outGain_, 1.f, 4.f);
 
         if (inGain_ > 0.f && lastInGain > 1.f)
             preampTubeState = ProcessNormal;
@@ -895,14 +913,9 @@ template <typename T> struct Channel : Processor
 
         pentode.inGain = outGain_;
 
-        FloatType autoGain = 1.0;
+        double autoGain = 1.0;
         bool ampAutoGain_ = *ampAutoGain;
 
-#if USE_SIMD
-        auto &&processBlock = simd.interleaveBlock(block);
-#else
-        auto &&processBlock = block;
-#endif
 
         if (*dist > 0.f) {
             mxr.processBlock(processBlock);
@@ -923,14 +936,7 @@ template <typename T> struct Channel : Processor
                 triode[1].process(processBlock);
             break;
         case ProcessRampOn: {
-            for (size_t ch = 0; ch < processBlock.getNumChannels(); ++ch)
-                tmp.copyFrom(ch, 0, processBlock.getChannelPointer(ch),
-                             processBlock.getNumSamples());
-#if USE_SIMD
-            auto tmpBlock = strix::AudioBlock<vec>(tmp);
-#else
-            auto tmpBlock = dsp::AudioBlock<FloatType>(tmp);
-#endif
+            auto tmpBlock = arena->copyOf(processBlock);
             setPreamp(inGain_);
             strix::SmoothGain<T>::applySmoothGain(processBlock, gain_raw,
                                                   lastInGain);
@@ -941,14 +947,7 @@ template <typename T> struct Channel : Processor
                                       processBlock.getNumSamples());
         } break;
         case ProcessRampOff: {
-            for (size_t ch = 0; ch < processBlock.getNumChannels(); ++ch)
-                tmp.copyFrom(ch, 0, processBlock.getChannelPointer(ch),
-                             processBlock.getNumSamples());
-#if USE_SIMD
-            auto tmpBlock = strix::AudioBlock<vec>(tmp);
-#else
-            auto tmpBlock = dsp::AudioBlock<FloatType>(tmp);
-#endif
+            auto tmpBlock = arena->copyOf(processBlock);
             setPreamp(inGain_);
             strix::SmoothGain<T>::applySmoothGain(processBlock, gain_raw,
                                                   lastInGain);
@@ -964,7 +963,7 @@ template <typename T> struct Channel : Processor
             autoGain *=
                 1.0 / std::sqrt(std::sqrt(gain_raw * gain_raw * gain_raw));
 
-        FloatType autoGain_m = 1.0;
+        double autoGain_m = 1.0;
         processFilters(processBlock, autoGain_m);
 
         if (ampAutoGain_)
@@ -980,14 +979,7 @@ template <typename T> struct Channel : Processor
             pentode.processBlockClassB(processBlock);
             break;
         case ProcessRampOn: {
-            for (size_t ch = 0; ch < processBlock.getNumChannels(); ++ch)
-                tmp.copyFrom(ch, 0, processBlock.getChannelPointer(ch),
-                             processBlock.getNumSamples());
-#if USE_SIMD
-            auto tmpBlock = strix::AudioBlock<vec>(tmp);
-#else
-            auto tmpBlock = dsp::AudioBlock<FloatType>(tmp);
-#endif
+            auto tmpBlock = arena->copyOf(processBlock);
             setPoweramp();
             strix::SmoothGain<T>::applySmoothGain(processBlock, out_raw,
                                                   lastOutGain);
@@ -996,14 +988,7 @@ template <typename T> struct Channel : Processor
                                       processBlock.getNumSamples());
         } break;
         case ProcessRampOff: {
-            for (size_t ch = 0; ch < processBlock.getNumChannels(); ++ch)
-                tmp.copyFrom(ch, 0, processBlock.getChannelPointer(ch),
-                             processBlock.getNumSamples());
-#if USE_SIMD
-            auto tmpBlock = strix::AudioBlock<vec>(tmp);
-#else
-            auto tmpBlock = dsp::AudioBlock<FloatType>(tmp);
-#endif
+            auto tmpBlock = arena->copyOf(processBlock);
             setPoweramp();
             strix::SmoothGain<T>::applySmoothGain(processBlock, out_raw,
                                                   lastOutGain);
@@ -1018,9 +1003,6 @@ template <typename T> struct Channel : Processor
 
         strix::SmoothGain<T>::applySmoothGain(processBlock, autoGain,
                                               lastAutoGain);
-#if USE_SIMD
-        simd.deinterleaveBlock(processBlock);
-#endif
     }
 
     SmoothedValue<float> sm_low, sm_mid, sm_hi;
@@ -1034,12 +1016,6 @@ template <typename T> struct Channel : Processor
     std::atomic<bool> updateFilters = false;
 
     double lastAutoGain = 1.0;
-#if USE_SIMD
-    strix::Buffer<T> tmp;
-#else
-    AudioBuffer<T> tmp;
-#endif
-
     enum TubeState
     {
         Bypassed,
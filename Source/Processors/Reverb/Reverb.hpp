@@ -121,10 +121,6 @@ template <int channels, typename Type> class Room
     {
         numChannels = spec.numChannels;
 
-        splitBuf.setSize(channels, spec.maximumBlockSize);
-        erBuf.setSize(channels, spec.maximumBlockSize);
-        wetBuf.setSize(2, spec.maximumBlockSize);
-
         preDelay.prepare(spec);
         preDelay.setMaximumDelayInSamples(spec.sampleRate);
 
@@ -159,6 +155,17 @@ template <int channels, typename Type> class Room
         sm_predelay.reset(128);
     }
 
+    void setWorker(Worker *w) { channelRunner.worker = w; }
+    void setArena(ScratchArena *a) { arena = a; }
+
+    /* peak arena use of process() */
+    static size_t scratchBytes(const dsp::ProcessSpec &spec)
+    {
+        return 2 * ScratchArena::bytesForBlock<double>(channels,
+                                                       spec.maximumBlockSize) +
+               ScratchArena::bytesForBlock<double>(2, spec.maximumBlockSize);
+    }
+
     void reset()
     {
         for (auto &d : diff)
@@ -171,58 +178,50 @@ template <int channels, typename Type> class Room
             for (auto &f : ch)
                 f.reset();
 
-        splitBuf.clear();
-        erBuf.clear();
-        wetBuf.clear();
-
         mix.reset();
     }
 
     void process(AudioBuffer<double> &buf, float amt)
     {
         const auto numSamples = buf.getNumSamples();
+        /* a mono buffer only needs one channel of dampening, predelay &
+         * mixing, just the FDN itself runs in stereo */
+        const auto nCh = (size_t)jmin(buf.getNumChannels(), numChannels);
 
-        if (numChannels > 1)
-            mix.pushDrySamples(
-                dsp::AudioBlock<double>(buf).getSubBlock(0, numSamples));
-        else
-            mix.pushDrySamples(dsp::AudioBlock<double>(buf)
-                                   .getSingleChannelBlock(0)
-                                   .getSubBlock(0, numSamples));
+        mix.pushDrySamples(
+            dsp::AudioBlock<double>(buf).getSubsetChannelBlock(0, nCh));
 
+        ScratchArena::Scope scope(*arena);
+        auto splitBuf = arena->allocateBuffer<double>(channels, numSamples);
+        auto erBuf = arena->allocateBuffer<double>(channels, numSamples);
         splitBuf.clear();
-        for (size_t ch = 0; ch < buf.getNumChannels(); ++ch)
-            FloatVectorOperations::copy(wetBuf.getWritePointer(ch),
-                                        buf.getReadPointer(ch), numSamples);
-
-        // need a sub-buffer which is numSamples-sized (wetBuf may be larger)
-        // it also must be stereo to accomadate the actual reverb algorithm
-        AudioBuffer<double> wetSubBuf(wetBuf.getArrayOfWritePointers(), 2,
-                                      numSamples);
-        // copy L->R if input buffer is mono
-        if (buf.getNumChannels() < 2)
-            wetSubBuf.copyFrom(1, 0, wetSubBuf.getReadPointer(0), numSamples);
+
+        // must be stereo to accomadate the actual reverb algorithm
+        auto wetSubBuf = arena->allocateBuffer<double>(2, numSamples);
+        for (size_t ch = 0; ch < nCh; ++ch)
+            FloatVectorOperations::copy(wetSubBuf.getWritePointer((int)ch),
+                                        buf.getReadPointer((int)ch),
+                                        numSamples);
 
         if (!params.bright)
-            dampenBuffer(wetSubBuf);
+            dampenBuffer(wetSubBuf, nCh);
 
-        dsp::AudioBlock<double> dsBlock(wetSubBuf);
-        if (numChannels > 1)
-            dsBlock = dsBlock.getSubBlock(0, numSamples);
-        else
-            dsBlock =
-                dsBlock.getSingleChannelBlock(0).getSubBlock(0, numSamples);
+        auto dsBlock =
+            dsp::AudioBlock<double>(wetSubBuf).getSubsetChannelBlock(0, nCh);
 
         if (sm_predelay.isSmoothing())
             processSmoothPredelay(dsBlock);
         else
             preDelay.process(dsp::ProcessContextReplacing<double>(dsBlock));
 
+        // copy L->R if input buffer is mono
+        if (nCh < 2)
+            wetSubBuf.copyFrom(1, 0, wetSubBuf.getReadPointer(0), numSamples);
+
         upMix.stereoToMulti(wetSubBuf.getArrayOfReadPointers(),
                             splitBuf.getArrayOfWritePointers(), numSamples);
 
         dsp::AudioBlock<double> block(splitBuf);
-        block = block.getSubBlock(0, numSamples);
 
         erBuf.clear();
 
@@ -236,25 +235,19 @@ template <int channels, typename Type> class Room
 
         feedback.process(block);
 
-        block.add(dsp::AudioBlock<double>(erBuf).getSubBlock(0, numSamples));
+        block.add(dsp::AudioBlock<double>(erBuf));
 
         upMix.multiToStereo(splitBuf.getArrayOfReadPointers(),
                             wetSubBuf.getArrayOfWritePointers(), numSamples);
 
-        wetSubBuf.applyGain(upMix.scalingFactor1());
+        dsBlock.multiplyBy(upMix.scalingFactor1());
 
         mix.setWetMixProportion(amt);
-        if (numChannels > 1)
-            mix.mixWetSamples(
-                dsp::AudioBlock<double>(wetSubBuf).getSubBlock(0, numSamples));
-        else
-            mix.mixWetSamples(dsp::AudioBlock<double>(wetSubBuf)
-                                  .getSingleChannelBlock(0)
-                                  .getSubBlock(0, numSamples));
+        mix.mixWetSamples(dsBlock);
 
-        for (size_t ch = 0; ch < buf.getNumChannels(); ++ch)
-            FloatVectorOperations::copy(buf.getWritePointer(ch),
-                                        wetSubBuf.getReadPointer(ch),
+        for (size_t ch = 0; ch < nCh; ++ch)
+            FloatVectorOperations::copy(buf.getWritePointer((int)ch),
+                                        wetSubBuf.getReadPointer((int)ch),
                                         numSamples);
     }
 
@@ -264,7 +257,6 @@ template <int channels, typename Type> class Room
         Diffuser<Type, channels>(0), Diffuser<Type, channels>(1),
         Diffuser<Type, channels>(2), Diffuser<Type, channels>(3)};
     MixedFeedback<Type, channels> feedback;
-    AudioBuffer<double> splitBuf, erBuf, wetBuf;
     StereoMultiMixer<Type, channels> upMix;
     dsp::DelayLine<double, dsp::DelayLineInterpolationTypes::Thiran> preDelay{
         44100};
@@ -272,6 +264,8 @@ template <int channels, typename Type> class Room
     int numChannels = 0;
     std::vector<dsp::IIR::Filter<Type>> lp[2];
     dsp::DryWetMixer<double> mix;
+    ChannelRunner channelRunner;
+    ScratchArena *arena = nullptr;
 
     void processSmoothPredelay(dsp::AudioBlock<double> &block)
     {
@@ -286,16 +280,17 @@ template <int channels, typename Type> class Room
     }
 
     // process Butterworth LP
-    void dampenBuffer(AudioBuffer<double> &buf)
+    void dampenBuffer(AudioBuffer<double> &buf, size_t numCh)
     {
         auto in = buf.getArrayOfWritePointers();
 
-        for (auto ch = 0; ch < buf.getNumChannels(); ++ch) {
-            for (auto i = 0; i < buf.getNumSamples(); ++i) {
+        const auto numSamples = (size_t)buf.getNumSamples();
+        channelRunner.process(numCh, numSamples, [&](size_t ch) {
+            for (size_t i = 0; i < numSamples; ++i) {
                 for (auto &f : lp[ch])
                     in[ch][i] = f.processSample(in[ch][i]);
             }
-        }
+        });
     }
 };
 
@@ -314,8 +309,9 @@ class ReverbManager
     };
     ReverbState state;
 
-    AudioBuffer<double> tmp;
-    strix::Crossfade fade;
+    // path 0 = the outgoing signal, held in arena scratch
+    Crossfader fade;
+    ScratchArena *arena = nullptr;
 
     strix::ChoiceParameter *type;
     uint8 lastType;
@@ -368,8 +364,6 @@ class ReverbManager
 
         state = type->getIndex() ? ProcessCurrentReverb : Bypassed;
 
-        tmp.setSize(spec.numChannels, spec.maximumBlockSize, false, true,
-                    false);
     }
 
     void reset()
@@ -378,6 +372,27 @@ class ReverbManager
         newRev->reset();
     }
 
+    void setWorker(Worker *w)
+    {
+        currentRev->setWorker(w);
+        newRev->setWorker(w);
+    }
+
+    void setArena(ScratchArena *a)
+    {
+        arena = a;
+        currentRev->setArena(a);
+        newRev->setArena(a);
+    }
+
+    /* peak arena use of process(): the outgoing path plus one room */
+    static size_t scratchBytes(const dsp::ProcessSpec &spec)
+    {
+        return ScratchArena::bytesForBlock<double>(spec.numChannels,
+                                                   spec.maximumBlockSize) +
+               Room<8, double>::scratchBytes(spec);
+    }
+
     void manageUpdate(bool changingPredelay)
     {
         float p = *predelay * 0.001f * reverb_samplerate;
@@ -422,6 +437,12 @@ class ReverbManager
             }
             // fade incoming, set fade time & flag
             fade.setFadeTime(reverb_samplerate, 0.5f);
+            /* two reverb tails are uncorrelated, keep their sum's power
+             * constant */
+            fade.setCurve(state == ProcessFadeBetween
+                              ? Crossfader::Curve::EqualPower
+                              : Crossfader::Curve::Linear);
+            fade.restart();
         } else {
             currentRev->setPredelay(p);
             lastPredelay = p;
@@ -436,16 +457,26 @@ class ReverbManager
             state ==
                 ProcessCurrentReverb) // check for param changes if no crossfade
         {
-            if (lastDecay != *decay && state != Bypassed)
-                manageUpdate(false);
-            if (lastSize != *size && state != Bypassed)
-                manageUpdate(false);
-            if (lastType != t)
+            /* a restored state or preset can change several of these at
+             * once, they all go into a single new reverb & fade */
+            const bool shapeChanged =
+                state != Bypassed && (lastDecay != *decay || lastSize != *size);
+            if (shapeChanged || lastType != t || lastBright != bright->get())
                 manageUpdate(false);
             if (lastPredelay != *predelay)
                 manageUpdate(true);
-            if (lastBright != bright->get())
-                manageUpdate(false);
+        }
+
+        /* while fading, the outgoing path lives in arena scratch and the
+         * fade writes back into buffer */
+        ScratchArena::Scope scope(*arena);
+        dsp::AudioBlock<double> block(buffer), out;
+        AudioBuffer<double> outBuf;
+        if (state != Bypassed && state != ProcessCurrentReverb) {
+            outBuf = arena->allocateBuffer<double>(buffer.getNumChannels(),
+                                                   buffer.getNumSamples());
+            out = dsp::AudioBlock<double>(outBuf);
+            out.copyFrom(block);
         }
 
         switch (state) {
@@ -458,30 +489,27 @@ class ReverbManager
             lastType = t;
             break;
         case ProcessFadeToWet:
-            tmp.makeCopyOf(buffer, true);
             newRev->process(buffer, amt);
-            fade.processWithState(tmp, buffer, buffer.getNumSamples());
-            if (fade.complete) {
+            fade.process(out, block, block);
+            if (!fade.isFading()) {
                 newRev.swap(currentRev);
                 lastType = t;
                 state = ProcessCurrentReverb;
             }
             break;
         case ProcessFadeToDry:
-            tmp.makeCopyOf(buffer, true);
-            currentRev->process(tmp, amt);
-            fade.processWithState(tmp, buffer, buffer.getNumSamples());
-            if (fade.complete) {
+            currentRev->process(outBuf, amt);
+            fade.process(out, block, block);
+            if (!fade.isFading()) {
                 lastType = t;
                 state = Bypassed;
             }
             break;
         case ProcessFadeBetween:
-            tmp.makeCopyOf(buffer, true);
-            currentRev->process(tmp, amt);
+            currentRev->process(outBuf, amt);
             newRev->process(buffer, amt);
-            fade.processWithState(tmp, buffer, buffer.getNumSamples());
-            if (fade.complete) {
+            fade.process(out, block, block);
+            if (!fade.isFading()) {
                 currentRev.swap(newRev);
                 lastType = t;
                 state = ProcessCurrentReverb;
@@ -0,0 +1,131 @@
+/**
+ * SVF.h
+ * Trapezoidal state variable filter, after Andrew Simper's "Linear
+ * Trapezoidal Integrated SVF"
+ */
+
+#pragma once
+
+/**
+ * Output = m0 * input + m1 * band + m2 * low, so every response is just a
+ * different mix. a1..a3 come from g = tan(pi * f / fs) & k = 1 / Q.
+ */
+struct SVFCoefficients
+{
+    double a1 = 1.0, a2 = 0.0, a3 = 0.0;
+    double m0 = 1.0, m1 = 0.0, m2 = 0.0;
+
+    enum Shelf
+    {
+        LowShelf,
+        HighShelf
+    };
+
+    /**
+     * A shelf & its mirror image, with the gain inverted, as used either side
+     * of the amp. They share one tan() & one pow(), which is what makes
+     * modulating them cheap. Matches the RBJ shelves of the same Q.
+     */
+    static void makeShelfPair(Shelf shape, double sampleRate, double freq,
+                              double q, double gainDb, SVFCoefficients &boost,
+                              SVFCoefficients &cut)
+    {
+        const auto t = std::tan(MathConstants<double>::pi *
+                                jmin(freq / sampleRate, 0.49));
+        const auto k = 1.0 / q;
+        const auto rootA = std::pow(10.0, gainDb / 80.0);
+        boost.setShelf(shape, t, k, rootA);
+        cut.setShelf(shape, t, k, 1.0 / rootA);
+    }
+
+    /* rootA is sqrt(A), A being the RBJ shelf amplitude 10^(dB / 40) */
+    void setShelf(Shelf shape, double t, double k, double rootA)
+    {
+        const auto A = rootA * rootA;
+        double g;
+        if (shape == LowShelf) {
+            g = t / rootA;
+            m0 = 1.0;
+            m1 = k * (A - 1.0);
+            m2 = A * A - 1.0;
+        } else {
+            g = t * rootA;
+            m0 = A * A;
+            m1 = k * (1.0 - A) * A;
+            m2 = 1.0 - A * A;
+        }
+        setG(g, k);
+    }
+
+    static constexpr double butterworthQ = 0.70710678118654752;
+
+    static SVFCoefficients makeLowPass(double sampleRate, double freq,
+                                       double q = butterworthQ)
+    {
+        SVFCoefficients c;
+        c.setG(std::tan(MathConstants<double>::pi *
+                        jmin(freq / sampleRate, 0.49)),
+               1.0 / q);
+        c.m0 = 0.0;
+        c.m1 = 0.0;
+        c.m2 = 1.0;
+        return c;
+    }
+
+    static SVFCoefficients makeHighPass(double sampleRate, double freq,
+                                        double q = butterworthQ)
+    {
+        SVFCoefficients c;
+        const auto k = 1.0 / q;
+        c.setG(std::tan(MathConstants<double>::pi *
+                        jmin(freq / sampleRate, 0.49)),
+               k);
+        c.m0 = 1.0;
+        c.m1 = -k;
+        c.m2 = -1.0;
+        return c;
+    }
+
+    void setG(double g, double k)
+    {
+        a1 = 1.0 / (1.0 + g * (g + k));
+        a2 = g * a1;
+        a3 = g * a2;
+    }
+
+    /* one sample through a section whose integrator states are ic1 & ic2 */
+    template <typename T> inline T process(T v0, T &ic1, T &ic2) const
+    {
+        const T v3 = v0 - ic2;
+        const T v1 = a1 * ic1 + a2 * v3;
+        const T v2 = ic2 + a2 * ic1 + a3 * v3;
+        ic1 = 2.0 * v1 - ic1;
+        ic2 = 2.0 * v2 - ic2;
+        return m0 * v0 + m1 * v1 + m2 * v2;
+    }
+};
+
+/**
+ * Unlike a direct-form biquad, the SVF's states are integrator outputs that
+ * stay valid when the coefficients move, so it can be modulated without
+ * zipper noise & the coefficients only need updating every few samples.
+ * One state per channel, T being double or vec.
+ */
+template <typename T, size_t numChannels = 2> struct SVF
+{
+    void reset()
+    {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            ic1eq[ch] = ic2eq[ch] = 0.0;
+    }
+
+    inline T processSample(size_t ch, T v0)
+    {
+        return coefficients.process(v0, ic1eq[ch], ic2eq[ch]);
+    }
+
+    SVFCoefficients coefficients;
+
+  private:
+    T ic1eq[numChannels]{}, ic2eq[numChannels]{};
+};
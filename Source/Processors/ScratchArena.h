@@ -0,0 +1,176 @@
+/**
+ * ScratchArena.h
+ * Per-instance scratch memory for the audio thread(s)
+ */
+
+#pragma once
+
+/**
+ * A bump allocator over memory owned by ScratchMemory. Allocations are
+ * released stack-style by a Scope, so a block's scratch costs a pointer bump
+ * and nothing is freed on the audio thread. Every allocation is cache-line
+ * aligned. An arena is only ever used from one thread.
+ *
+ * Running out is a sizing bug, but it never hands out null: the arena falls
+ * back to its spill region, which holds the largest single allocation the
+ * chain makes, & flags the overflow so the block can be passed through.
+ */
+class ScratchArena
+{
+  public:
+    static constexpr size_t alignment = 64;
+
+    static constexpr size_t roundUp(size_t numBytes)
+    {
+        return (numBytes + alignment - 1) & ~(alignment - 1);
+    }
+
+    /* bytes taken by allocateChannels<T>(numChannels, numSamples) */
+    template <typename T>
+    static constexpr size_t bytesForBlock(size_t numChannels,
+                                          size_t numSamples)
+    {
+        return roundUp(numChannels * sizeof(T *)) +
+               numChannels * roundUp(numSamples * sizeof(T));
+    }
+
+    ScratchArena() = default;
+    ScratchArena(char *data, size_t numBytes, char *spillData,
+                 size_t spillBytes)
+        : base(data), spill(spillData), capacity(numBytes),
+          spillCapacity(spillBytes)
+    {
+    }
+
+    /* releases everything allocated after it was created */
+    struct Scope
+    {
+        Scope(ScratchArena &a) : arena(a), mark(a.top) {}
+        ~Scope() { arena.top = mark; }
+
+      private:
+        ScratchArena &arena;
+        const size_t mark;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    /* uninitialized, valid until the enclosing Scope ends */
+    template <typename T> T *allocate(size_t num)
+    {
+        const auto numBytes = roundUp(num * sizeof(T));
+        if (top + numBytes > capacity)
+            return reinterpret_cast<T *>(allocateSpill(numBytes));
+        auto *ptr = base + top;
+        top += numBytes;
+        return reinterpret_cast<T *>(ptr);
+    }
+
+    template <typename T> T **allocateChannels(size_t numChannels,
+                                               size_t numSamples)
+    {
+        auto **channels = allocate<T *>(numChannels);
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            channels[ch] = allocate<T>(numSamples);
+        return channels;
+    }
+
+    /* a block of the same type & shape as block, uninitialized */
+    template <typename Block> Block allocateLike(const Block &block)
+    {
+        using T = std::remove_pointer_t<decltype(block.getChannelPointer(0))>;
+        return Block(allocateChannels<std::remove_const_t<T>>(
+                         block.getNumChannels(), block.getNumSamples()),
+                     block.getNumChannels(), block.getNumSamples());
+    }
+
+    template <typename Block> Block copyOf(const Block &block)
+    {
+        auto copy = allocateLike(block);
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            std::copy(block.getChannelPointer(ch),
+                      block.getChannelPointer(ch) + block.getNumSamples(),
+                      copy.getChannelPointer(ch));
+        return copy;
+    }
+
+    /* an AudioBuffer referring to arena memory, for code that wants one */
+    template <typename T>
+    AudioBuffer<T> allocateBuffer(int numChannels, int numSamples)
+    {
+        return AudioBuffer<T>(
+            allocateChannels<T>((size_t)numChannels, (size_t)numSamples),
+            numChannels, numSamples);
+    }
+
+    /* true if anything spilled since the last call, the block that did
+     * holds garbage */
+    bool takeOverflow()
+    {
+        const auto o = overflowed;
+        overflowed = false;
+        spillTop = 0;
+        return o;
+    }
+
+    size_t getCapacity() const { return capacity; }
+    size_t getUsed() const { return top; }
+
+  private:
+    /* prepareToPlay() sizes every region for the worst case, so getting here
+     * is a sizing bug. The spill region wraps when it fills: what's written
+     * to it is thrown away, it only has to be memory the block may touch */
+    char *allocateSpill(size_t numBytes)
+    {
+        jassertfalse;
+        jassert(numBytes <= spillCapacity);
+        overflowed = true;
+        if (spillTop + numBytes > spillCapacity)
+            spillTop = 0;
+        auto *ptr = spill + spillTop;
+        spillTop += numBytes;
+        return ptr;
+    }
+
+    char *base = nullptr, *spill = nullptr;
+    size_t capacity = 0, top = 0, spillCapacity = 0, spillTop = 0;
+    bool overflowed = false;
+};
+
+/**
+ * Owns one contiguous allocation split into independent arenas, one per
+ * thread that processes audio, so the pipeline's stages never share one.
+ * Each arena also gets its own spill region of maxAllocBytes.
+ */
+template <size_t numRegions> class ScratchMemory
+{
+  public:
+    /* the only allocation, call from prepareToPlay. maxAllocBytes is the
+     * largest single allocation, one channel of the longest block */
+    void prepare(const std::array<size_t, numRegions> &regionBytes,
+                 size_t maxAllocBytes)
+    {
+        const auto spillBytes = ScratchArena::roundUp(maxAllocBytes);
+        size_t total = numRegions * spillBytes;
+        for (auto bytes : regionBytes)
+            total += ScratchArena::roundUp(bytes);
+
+        storage.allocate(total + ScratchArena::alignment, true);
+        auto *ptr = storage.get();
+        ptr += (ScratchArena::alignment -
+                ((uintptr_t)ptr & (ScratchArena::alignment - 1))) &
+               (ScratchArena::alignment - 1);
+
+        for (size_t i = 0; i < numRegions; ++i) {
+            const auto bytes = ScratchArena::roundUp(regionBytes[i]);
+            regions[i] = ScratchArena(ptr, bytes, ptr + bytes, spillBytes);
+            ptr += bytes + spillBytes;
+        }
+    }
+
+    ScratchArena &operator[](size_t region) { return regions[region]; }
+
+  private:
+    HeapBlock<char> storage;
+    std::array<ScratchArena, numRegions> regions;
+};
@@ -90,33 +90,70 @@ template <typename T> struct NodalCoeffs
         A1 = (T)-3.0 * a0 - a1 * c + a2 * c * c + (T)3.0 * a3 * c * c * c;
         A2 = (T)-3.0 * a0 + a1 * c + a2 * c * c - (T)3.0 * a3 * c * c * c;
         A3 = -a0 + a1 * c - a2 * c * c + a3 * c * c * c;
+
+        const auto g = (T)1.0 / A0;
+        nb0 = B0 * g;
+        nb1 = B1 * g;
+        nb2 = B2 * g;
+        nb3 = B3 * g;
+        na1 = A1 * g;
+        na2 = A2 * g;
+        na3 = A3 * g;
+        tdfValid[0] = tdfValid[1] = false;
     }
 
     void reset() noexcept
     {
-        z1[0] = z2[0] = z3[0], z1[1] = z2[1] = z3[1], x1[0] = x2[0] = x3[0],
-        x1[1] = x2[1] = x3[1] = 0.0;
+        for (size_t ch = 0; ch < 2; ++ch) {
+            z1[ch] = z2[ch] = z3[ch] = x1[ch] = x2[ch] = x3[ch] = 0.0;
+            s1[ch] = s2[ch] = s3[ch] = 0.0;
+            tdfValid[ch] = true;
+        }
     }
 
+    /**
+     * Fixed coefficients: transposed direct form II, three states instead of
+     * six. The input & output history is brought up to date from the block's
+     * last samples, ready for a switch to processSample().
+     */
     void processSamples(T *x, size_t ch, size_t numSamples) noexcept
     {
-        for (size_t i = 0; i < numSamples; ++i) {
-            auto y = (1.f / A0) *
-                     (B0 * x[i] + B1 * x1[ch] + B2 * x2[ch] + B3 * x3[ch] -
-                      A1 * z1[ch] - A2 * z2[ch] - A3 * z3[ch]);
+        if (!tdfValid[ch])
+            loadStates(ch);
 
-            z3[ch] = z2[ch];
-            z2[ch] = z1[ch];
-            z1[ch] = y;
+        const auto tail = jmin(numSamples, (size_t)3);
+        T lastIn[3];
+        for (size_t k = 0; k < tail; ++k)
+            lastIn[k] = x[numSamples - tail + k];
+
+        auto z1_ = s1[ch], z2_ = s2[ch], z3_ = s3[ch];
+        for (size_t i = 0; i < numSamples; ++i) {
+            const auto in = x[i];
+            const auto y = nb0 * in + z1_;
+            z1_ = nb1 * in - na1 * y + z2_;
+            z2_ = nb2 * in - na2 * y + z3_;
+            z3_ = nb3 * in - na3 * y;
+            x[i] = y;
+        }
+        s1[ch] = z1_;
+        s2[ch] = z2_;
+        s3[ch] = z3_;
 
+        for (size_t k = 0; k < tail; ++k) {
             x3[ch] = x2[ch];
             x2[ch] = x1[ch];
-            x1[ch] = x[i];
-
-            x[i] = y;
+            x1[ch] = lastIn[k];
+            z3[ch] = z2[ch];
+            z2[ch] = z1[ch];
+            z1[ch] = x[numSamples - tail + k];
         }
     }
 
+    /**
+     * While the coefficients are smoothing: direct form I, whose states are
+     * just past inputs & outputs, so they stay valid as the coefficients
+     * move under them.
+     */
     inline T processSample(T x, size_t ch) noexcept
     {
         auto y =
@@ -131,13 +168,28 @@ template <typename T> struct NodalCoeffs
         x2[ch] = x1[ch];
         x1[ch] = x;
 
+        tdfValid[ch] = false;
         return y;
     }
 
   private:
+    /* the transposed form's states that continue the direct form's history */
+    void loadStates(size_t ch) noexcept
+    {
+        s1[ch] = nb1 * x1[ch] - na1 * z1[ch] + nb2 * x2[ch] - na2 * z2[ch] +
+                 nb3 * x3[ch] - na3 * z3[ch];
+        s2[ch] = nb2 * x1[ch] - na2 * z1[ch] + nb3 * x2[ch] - na3 * z2[ch];
+        s3[ch] = nb3 * x1[ch] - na3 * z1[ch];
+        tdfValid[ch] = true;
+    }
+
     T c = 88200.0, b1 = 0, b2 = 0, b3 = 0, a0 = 0, a1 = 0, a2 = 0, a3 = 0,
       B0 = 0, B1 = 0, B2 = 0, B3 = 0, A0 = 1.0, A1 = 0, A2 = 0, A3 = 0;
     T z1[2]{0.f}, z2[2]{0.f}, z3[2]{0.f}, x1[2]{0.f}, x2[2]{0.f}, x3[2]{0.f};
+    /* normalised by A0 for the transposed form, & its states */
+    T nb0 = 0, nb1 = 0, nb2 = 0, nb3 = 0, na1 = 0, na2 = 0, na3 = 0;
+    T s1[2]{0.f}, s2[2]{0.f}, s3[2]{0.f};
+    bool tdfValid[2]{true, true};
     T C1 = 0.25e-9f, C2 = 22e-9f, C3 = 22e-9f, R1 = 300e3f, R2 = 0.5e6f,
       R3 = 30e3f, R4 = 56e3f;
 };
@@ -295,10 +347,11 @@ template <typename T> struct ToneStack : PreampProcessor
     void process(strix::AudioBlock<vec> &block) override
     {
         if (bass.isSmoothing() || mid.isSmoothing() || treble.isSmoothing()) {
-            for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-                auto in = block.getChannelPointer(ch);
-                for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                    updateCoeffs();
+            /* one coefficient step per sample, whatever the channel count */
+            for (size_t i = 0; i < block.getNumSamples(); ++i) {
+                updateCoeffs();
+                for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+                    auto in = block.getChannelPointer(ch);
                     in[i] = type ? bCoeffs.processSample(in[i], ch)
                                  : nCoeffs.processSample(in[i], ch);
                 }
@@ -317,10 +370,11 @@ template <typename T> struct ToneStack : PreampProcessor
     void process(dsp::AudioBlock<double> &block) override
     {
         if (bass.isSmoothing() || mid.isSmoothing() || treble.isSmoothing()) {
-            for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
-                auto in = block.getChannelPointer(ch);
-                for (size_t i = 0; i < block.getNumSamples(); ++i) {
-                    updateCoeffs();
+            /* one coefficient step per sample, whatever the channel count */
+            for (size_t i = 0; i < block.getNumSamples(); ++i) {
+                updateCoeffs();
+                for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+                    auto in = block.getChannelPointer(ch);
                     in[i] = type ? bCoeffs.processSample(in[i], ch)
                                  : nCoeffs.processSample(in[i], ch);
                 }
@@ -48,12 +48,6 @@ template <typename T> struct Pentode
 
     void prepare(const dsp::ProcessSpec &spec)
     {
-        for (auto &f : dcBlock) {
-            f.prepare(spec);
-            f.setCutoffFreq(10.0);
-            f.setType(strix::FilterType::highpass);
-        }
-
         sc_lp.prepare(spec);
         sc_lp.setType(strix::FilterType::lowpass);
         sc_lp.setCutoffFreq(5.0);
@@ -68,8 +62,6 @@ template <typename T> struct Pentode
 
     void reset()
     {
-        for (auto &f : dcBlock)
-            f.reset();
         sc_lp.reset();
     }
 
@@ -103,24 +95,29 @@ template <typename T> struct Pentode
         }
     }
 
+    /**
+     * Both half-waves & their second stage in one expression. Each stage is
+     * x / (1 + |x| / L), which composes to x / (1 + |x| * (1 / L1 + 1 / L2)),
+     * & the pos & neg waves only swap gp & gn, so their average needs no
+     * select & a single division.
+     */
     void processSamplesClassic(T *in, size_t ch, size_t numSamples, T gp, T gn)
     {
         float bpPreGain = jmap(inGain, 1.f, -1.f);
         float bpPostGain = -bpPreGain;
+        const T cp = 1.0 / gp + 1.0 / 2.01;
+        const T cn = 1.0 / gn + 1.0 / 2.01;
+        const T h = 0.5 * (cp + cn);
         for (size_t i = 0; i < numSamples; ++i) {
             in[i] += bpPreGain * bpPre.processSample(ch, in[i]);
             in[i] -= 0.8 * processEnvelopeDetector(in[i], ch);
 
-            T yn_pos = classicPentode(in[i], gn, gp);
-            T yn_neg = classicPentode(in[i], gp, gn);
-
-            dcBlock[0].processSample(ch, yn_pos);
-            dcBlock[1].processSample(ch, yn_neg);
-
-            yn_pos = classicPentode(yn_pos, 2.01, 2.01);
-            yn_neg = classicPentode(yn_neg, 2.01, 2.01);
-
-            in[i] = 0.5 * (yn_pos + yn_neg);
+#if USE_SIMD
+            const T a = xsimd::abs(in[i]);
+#else
+            const T a = std::abs(in[i]);
+#endif
+            in[i] = in[i] * (1.0 + a * h) / ((1.0 + a * cp) * (1.0 + a * cn));
             in[i] += bpPostGain * bpPost.processSample(ch, in[i]);
         }
     }
@@ -146,19 +143,6 @@ template <typename T> struct Pentode
 #endif
     }
 
-    inline T classicPentode(T xn, T Ln, T Lp, T g = 1.0)
-    {
-#if USE_SIMD
-        return xsimd::select(xn <= 0.0, (g * xn) / (1.0 - ((g * xn) / Ln)),
-                             (g * xn) / (1.0 + ((g * xn) / Lp)));
-#else
-        if (xn <= 0.0)
-            return (xn * g) / (1.0 - ((g * xn) / Ln));
-        else
-            return (xn * g) / (1.0 + ((g * xn) / Lp));
-#endif
-    }
-
     inline T processEnvelopeDetector(T x, int ch)
     {
 #if USE_SIMD
@@ -169,7 +153,6 @@ template <typename T> struct Pentode
         return 0.151188 * sc_lp.processSample(ch, x);
     }
 
-    std::array<strix::SVTFilter<T>, 2> dcBlock; /*need 2 for pos & neg signals*/
     strix::SVTFilter<T> sc_lp, bpPre, bpPost;
 };
 
@@ -207,46 +190,24 @@ template <typename T> struct AVTriode : PreampProcessor
         sc_hp.reset();
     }
 
+    /**
+     * The bias only moves on a model switch, so most blocks take the constant
+     * path, where the loops have no smoother calls & the scalar build can
+     * vectorize them.
+     */
     template <TriodeType mode = VintageTube>
     inline void processSamples(T *x, size_t ch, size_t numSamples)
     {
         sm_gp.setTargetValue(bias.first);
         sm_gn.setTargetValue(bias.second);
-        switch (mode) {
-        case VintageTube:
-            for (size_t i = 0; i < numSamples; ++i) {
-                auto p = sm_gp.getNextValue();
-                auto n = sm_gn.getNextValue();
-#if USE_SIMD
-                x[i] = xsimd::select(x[i] > 0.0,
-                                     (x[i] + (x[i] * x[i])) /
-                                         (1.0 + p * x[i] * x[i]),
-                                     x[i] / (1.0 - n * x[i]));
-#else
-                if (x[i] > 0.0)
-                    x[i] = (x[i] + x[i] * x[i]) / (1.0 + p * x[i] * x[i]);
-                else
-                    x[i] = x[i] / (1.0 - n * x[i]);
-#endif
-            }
-            break;
-        case ModernTube:
-            for (size_t i = 0; i < numSamples; ++i) {
-                auto p = sm_gp.getNextValue();
-                x[i] = (1.f / p) * strix::fast_tanh(p * x[i]);
-            }
-            break;
-        case ChannelTube:
-            for (size_t i = 0; i < numSamples; ++i) {
-                auto p = sm_gp.getNextValue();
-                auto n = sm_gn.getNextValue();
-                auto f1 = (1.f / p) * strix::tanh(p * x[i]) * y_m[ch];
-                auto f2 = (1.f / n) * strix::atan(n * x[i]) * (1.f - y_m[ch]);
-
-                x[i] = f1 + f2;
-                y_m[ch] = sc_hp.processSample(ch, x[i]);
-            }
-            break;
+        if (sm_gp.isSmoothing() || sm_gn.isSmoothing()) {
+            processKernel<mode>(
+                x, ch, numSamples, [this] { return sm_gp.getNextValue(); },
+                [this] { return sm_gn.getNextValue(); });
+        } else {
+            const auto p = sm_gp.getTargetValue(), n = sm_gn.getTargetValue();
+            processKernel<mode>(
+                x, ch, numSamples, [p] { return p; }, [n] { return n; });
         }
     }
 
@@ -293,6 +254,47 @@ template <typename T> struct AVTriode : PreampProcessor
     bias_t bias;
 
   private:
+    template <TriodeType mode, typename NextP, typename NextN>
+    inline void processKernel(T *x, size_t ch, size_t numSamples,
+                              NextP &&nextP, NextN &&nextN)
+    {
+        switch (mode) {
+        case VintageTube:
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto p = nextP();
+                auto n = nextN();
+#if USE_SIMD
+                x[i] = xsimd::select(x[i] > 0.0,
+                                     (x[i] + (x[i] * x[i])) /
+                                         (1.0 + p * x[i] * x[i]),
+                                     x[i] / (1.0 - n * x[i]));
+#else
+                x[i] = x[i] > 0.0
+                           ? (x[i] + x[i] * x[i]) / (1.0 + p * x[i] * x[i])
+                           : x[i] / (1.0 - n * x[i]);
+#endif
+            }
+            break;
+        case ModernTube:
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto p = nextP();
+                x[i] = (1.f / p) * strix::fast_tanh(p * x[i]);
+            }
+            break;
+        case ChannelTube:
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto p = nextP();
+                auto n = nextN();
+                auto f1 = (1.f / p) * strix::tanh(p * x[i]) * y_m[ch];
+                auto f2 = (1.f / n) * strix::atan(n * x[i]) * (1.f - y_m[ch]);
+
+                x[i] = f1 + f2;
+                y_m[ch] = sc_hp.processSample(ch, x[i]);
+            }
+            break;
+        }
+    }
+
     std::vector<T> y_m;
     strix::SVTFilter<T> sc_hp;
     SmoothedValue<double> sm_gp, sm_gn;
@@ -0,0 +1,153 @@
+/**
+ * Worker.h
+ * A background thread that runs one job at a time on behalf of the audio
+ * thread
+ */
+
+#pragma once
+
+#if JUCE_INTEL
+#include <emmintrin.h>
+#endif
+
+/**
+ * The audio thread waits on this thread's jobs, so it runs at realtime
+ * priority (Thread::startRealtimeThread, JUCE 7.0.3 or later), and
+ * waitForJob() spins for up to maxSpinSeconds before it sleeps, since most
+ * jobs finish within microseconds of the caller's own share of the work.
+ *
+ * Each Worker is its own thread, so the processor only starts them for
+ * offline renders, where one instance may use more than one core. The CLAP
+ * thread-pool extension would be the shared alternative, but the
+ * clap-juce-extensions wrapper doesn't expose it in this tree.
+ */
+struct Worker : private Thread
+{
+    Worker(const String &name) : Thread(name) {}
+
+    ~Worker() { stop(); }
+
+    void start()
+    {
+        if (!isThreadRunning())
+            startRealtimeThread(RealtimeOptions{}.withPriority(10));
+    }
+
+    void stop()
+    {
+        if (!isThreadRunning())
+            return;
+        signalThreadShouldExit();
+        jobReady.signal();
+        stopThread(1000);
+        busy = false;
+    }
+
+    bool isRunning() const { return isThreadRunning(); }
+
+    /**
+     * Hand a job to the worker. The callable must stay alive and its data
+     * must not be touched until waitForJob() returns.
+     */
+    template <typename Fn> void dispatch(Fn &fn)
+    {
+        jassert(!busy);
+        ctx = &fn;
+        call = [](void *p) { (*static_cast<Fn *>(p))(); };
+        busy = true;
+        done.store(false, std::memory_order_relaxed);
+        jobReady.signal();
+    }
+
+    void waitForJob()
+    {
+        if (!busy)
+            return;
+        const auto deadline = Time::getHighResolutionTicks() + spinTicks;
+        while (!done.load(std::memory_order_acquire)) {
+            if (Time::getHighResolutionTicks() > deadline) {
+                jobDone.wait();
+                busy = false;
+                return;
+            }
+            pause();
+        }
+        /* the job signals before it sets done, so this consumes that signal
+         * without blocking */
+        jobDone.wait(0);
+        busy = false;
+    }
+
+  private:
+    void run() override
+    {
+        while (!threadShouldExit()) {
+            jobReady.wait();
+            if (threadShouldExit())
+                break;
+            call(ctx);
+            jobDone.signal();
+            done.store(true, std::memory_order_release);
+        }
+    }
+
+    /* tells the core this is a spin-wait, so it doesn't starve a sibling
+     * hyperthread or burn power */
+    static void pause() noexcept
+    {
+#if JUCE_INTEL
+        _mm_pause();
+#elif JUCE_ARM && (JUCE_CLANG || JUCE_GCC)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+    static constexpr double maxSpinSeconds = 50.0e-6;
+    const int64 spinTicks = Time::secondsToHighResolutionTicks(maxSpinSeconds);
+
+    WaitableEvent jobReady, jobDone;
+    std::atomic<bool> done{false};
+    void (*call)(void *) = nullptr;
+    void *ctx = nullptr;
+    bool busy = false;
+
+    JUCE_DECLARE_NON_COPYABLE(Worker)
+};
+
+/**
+ * Runs a per-channel job with channel 0 on the calling thread and the
+ * remaining channels on a Worker. Falls back to a plain loop for mono, small
+ * blocks, or when no worker is running, since waking a thread costs more than
+ * filtering a few hundred samples.
+ */
+struct ChannelRunner
+{
+    static constexpr size_t minBlockSize = 512;
+
+    Worker *worker = nullptr;
+
+    bool shouldSplit(size_t numChannels, size_t numSamples) const
+    {
+        return numChannels > 1 && numSamples >= minBlockSize &&
+               worker != nullptr && worker->isRunning();
+    }
+
+    /* fn(ch) must only touch state belonging to channel ch */
+    template <typename Fn>
+    void process(size_t numChannels, size_t numSamples, Fn &&fn)
+    {
+        if (!shouldSplit(numChannels, numSamples)) {
+            for (size_t ch = 0; ch < numChannels; ++ch)
+                fn(ch);
+            return;
+        }
+
+        auto job = [&] {
+            for (size_t ch = 1; ch < numChannels; ++ch)
+                fn(ch);
+        };
+        worker->dispatch(job);
+        fn(0);
+        worker->waitForJob();
+    }
+};
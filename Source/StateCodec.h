@@ -0,0 +1,72 @@
+// StateCodec.h
+
+#pragma once
+#include <JuceHeader.h>
+
+/**
+ * Compact binary plugin state: a header, the preset name, then every
+ * parameter's ID & plain value. Restoring sets the parameters directly,
+ * without building or parsing any XML. Blobs that don't start with the magic
+ * number are older XML states, which the caller still reads the old way.
+ */
+namespace StateCodec
+{
+constexpr int magic = 0x5453414f; // "OAST"
+constexpr int version = 1;
+
+inline void write(AudioProcessorValueTreeState &apvts, const String &preset,
+                  MemoryBlock &dest)
+{
+    Array<RangedAudioParameter *> params;
+    for (auto *param : apvts.processor.getParameters())
+        if (auto *p = dynamic_cast<RangedAudioParameter *>(param))
+            params.add(p);
+
+    MemoryOutputStream out(dest, false);
+    out.writeInt(magic);
+    out.writeShort((short)version);
+    out.writeString(preset);
+    out.writeCompressedInt(params.size());
+    for (auto *p : params) {
+        out.writeString(p->paramID);
+        out.writeFloat(apvts.getRawParameterValue(p->paramID)->load());
+    }
+}
+
+/**
+ * Parameters missing from the blob (added in a later version) go back to
+ * their defaults, as they would when loading an XML state.
+ * @return false if data isn't a binary state this version can read
+ */
+inline bool read(AudioProcessorValueTreeState &apvts, const void *data,
+                 int sizeInBytes, String &preset)
+{
+    MemoryInputStream in(data, (size_t)sizeInBytes, false);
+    if (sizeInBytes < 6 || in.readInt() != magic)
+        return false;
+    if (in.readShort() > version) {
+        jassertfalse; // saved by a newer build
+        return false;
+    }
+
+    preset = in.readString();
+    const auto &params = apvts.processor.getParameters();
+    std::vector<bool> restored((size_t)params.size(), false);
+
+    const int numParams = in.readCompressedInt();
+    for (int i = 0; i < numParams && !in.isExhausted(); ++i) {
+        const auto paramID = in.readString();
+        const auto value = in.readFloat();
+        if (auto *p = apvts.getParameter(paramID)) {
+            p->setValueNotifyingHost(p->convertTo0to1(value));
+            restored[(size_t)p->getParameterIndex()] = true;
+        }
+    }
+
+    for (auto *param : params)
+        if (!restored[(size_t)param->getParameterIndex()])
+            param->setValueNotifyingHost(param->getDefaultValue());
+
+    return true;
+}
+} // namespace StateCodec
@@ -57,12 +57,13 @@ class MenuComponent : public Component
 #if !JUCE_MAC
     ListButton openGL;
 #endif
-    ListButton HQ, renderHQ, windowSize, checkUpdate, showTooltips, activate;
+    ListButton HQ, renderHQ, lowLatency, fastDiodes, windowSize, checkUpdate,
+        showTooltips, activate;
 
     bool openGLOn = false, showTooltipsOn = false;
 
     std::unique_ptr<AudioProcessorValueTreeState::ButtonAttachment> hqAttach,
-        renderHQAttach;
+        renderHQAttach, lowLatencyAttach, fastDiodesAttach;
 
   public:
     MenuComponent(AudioProcessorValueTreeState &a, var isActivated)
@@ -85,6 +86,20 @@ class MenuComponent : public Component
         renderHQ.setTooltip("Enable 4x oversampling when rendering. Useful if "
                             "you want to save some CPU while mixing.");
 
+        lowLatency.setButtonText("Min-phase HQ");
+        lowLatency.toggle = true;
+        lowLatency.setClickingTogglesState(true);
+        lowLatency.setTooltip("Use minimum-phase oversampling filters in HQ. "
+                              "About 6 samples of latency instead of the "
+                              "linear-phase filters' much longer delay, for "
+                              "tracking & monitoring through OmniAmp");
+
+        fastDiodes.setButtonText("Fast pedal diodes");
+        fastDiodes.toggle = true;
+        fastDiodes.setClickingTogglesState(true);
+        fastDiodes.setTooltip("Use an approximate diode model in the pedal "
+                              "distortion to save CPU");
+
         windowSize.setButtonText("Default UI size");
         windowSize.setTooltip("Reset window size to default dimensions");
         windowSize.setClickingTogglesState(false);
@@ -120,6 +135,10 @@ class MenuComponent : public Component
             m.addCustomItem(2, HQ, getWidth(), 35, false, nullptr, "HQ");
             m.addCustomItem(3, renderHQ, getWidth(), 35, false, nullptr,
                             "Render HQ");
+            m.addCustomItem(8, lowLatency, getWidth(), 35, false, nullptr,
+                            "Min-phase HQ");
+            m.addCustomItem(9, fastDiodes, getWidth(), 35, false, nullptr,
+                            "Fast pedal diodes");
             showTooltipsOn =
                 (bool)strix::readConfigFile(CONFIG_PATH, "tooltips");
             showTooltips.setToggleState(showTooltipsOn,
@@ -155,6 +174,16 @@ class MenuComponent : public Component
                             !renderHQ.getToggleState(),
                             NotificationType::sendNotificationAsync);
                         break;
+                    case 8:
+                        lowLatency.setToggleState(
+                            !lowLatency.getToggleState(),
+                            NotificationType::sendNotificationAsync);
+                        break;
+                    case 9:
+                        fastDiodes.setToggleState(
+                            !fastDiodes.getToggleState(),
+                            NotificationType::sendNotificationAsync);
+                        break;
                     case 4:
                         if (showTooltipCallback)
                             showTooltipCallback(!showTooltipsOn);
@@ -183,6 +212,12 @@ class MenuComponent : public Component
         renderHQAttach =
             std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(
                 vts, "renderHQ", renderHQ);
+        lowLatencyAttach =
+            std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(
+                vts, "hqLowLatency", lowLatency);
+        fastDiodesAttach =
+            std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(
+                vts, "fastDiodes", fastDiodes);
     }
 
     std::function<void()> windowResizeCallback;